@@ -12,6 +12,20 @@
 //+------------------------------------------------------------------+
 #property strict
 
+#include <Generic\HashMap.mqh>
+
+//--- Aquecimento: descomente a linha abaixo para calcular RSI, CCI e MACD do aquecimento com os
+//--- laços escalares de referência em vez das operações de vector.
+//#define TD_SCALAR_KERNELS
+
+//--- Latência: descomente a linha abaixo para remover as medições de tempo por etapa.
+//--- Sem ela, cada medição custa duas leituras de GetMicrosecondCount e um incremento de histograma.
+//#define TD_NO_LATENCY
+
+//--- Log: descomente a linha abaixo para compilar as mensagens de depuração.
+//--- Sem ela, as chamadas LOG_DEBUG são removidas por completo (nem o texto é montado).
+//#define TD_DEBUG_LOG
+
 //--- Definições de cores para a interface do painel
 #define clrDarkBg           C'28,28,28'       // #1C1C1C - Cinza escuro para o fundo principal
 #define clrGridLines        C'28,28,28'       // #1C1C1C - Cinza escuro para as linhas da grade
@@ -26,6 +40,92 @@
 #define clrWarning          C'255,200,0'      // Laranja para avisos ou estados de atenção
 #define clrHeaderSymbols    C'220,210,255'    // #DCD2FF - Lilás bem fraquinho para fundo do cabeçalho do painel (RGB: 220,210,255)
 
+//--- Níveis de log do painel
+enum ENUM_TD_LOG_LEVEL
+{
+   TD_LOG_DEBUG,                      // Depuração (requer TD_DEBUG_LOG na compilação)
+   TD_LOG_INFO,                       // Informações
+   TD_LOG_WARN,                       // Avisos
+   TD_LOG_ERROR,                      // Erros
+   TD_LOG_OFF                         // Nenhuma mensagem
+};
+
+#define LOG_RING_SIZE       256               // Mensagens guardadas entre dois descarregamentos do log
+#define LOG_PRINT_CHARS     2000              // Maior texto enviado ao diário por Print (mensagens unidas por "\n")
+#define TICKS_PER_CALL      20000             // Máximo de ticks lidos por símbolo a cada frame
+#define BOOK_DEPTH          32                // Níveis de cada lado do livro considerados na pressão do DOM
+#define PROFILE_INITIAL_BINS 1024             // Níveis de preço reservados no início do perfil de volume
+#define PROFILE_MAX_BINS    65536             // Maior histograma do perfil; ticks que exigiriam mais são descartados
+#define STATS_REPORT_SEC    60                // Intervalo (s) entre os relatórios de estatísticas no diário
+#define HANDLE_CREATES_PER_FRAME 8            // Handles de indicador criados por frame (não trava a inicialização)
+#define INDICATOR_MAX_BUFFERS 5               // Maior número de buffers lidos de um indicador (Ichimoku)
+#define INDICATOR_RETRY_SEC 10                // Espera (s) antes de tentar de novo um handle que falhou
+#define INDICATOR_MAX_RETRIES 5               // Tentativas de criação antes de deixar a linha em erro
+#define TICK_FILE_MAGIC     0x4B544454        // "TDTK": identifica os arquivos de ticks gravados pelo painel
+#define TICK_FILE_VERSION   1                 // Versão do formato do arquivo de ticks
+#define TICK_FILE_CHUNK     65536             // Bytes lidos/gravados por operação no arquivo de ticks
+#define SYNTH_TICK_SIZE     0.01              // Tick size dos símbolos sintéticos
+#define SYNTH_SEED          20240101          // Semente fixa do gerador sintético (sessões reproduzíveis)
+#define BENCH_FRAMES        20                // Frames medidos por tamanho no benchmark
+#define BENCH_SWITCHES      10                // Trocas de aba (e minimizar/restaurar) medidas por tamanho
+#define BENCH_BOOK_EVENTS   100000            // Eventos de livro sintéticos medidos no benchmark
+#define SHOW_ROWS_ALL       0x7FF             // Máscara de ShowRowsMask com todas as linhas visíveis
+#define SNAPSHOT_MAGIC      0x4E534454        // "TDSN": identifica o arquivo de estado do painel
+#define SNAPSHOT_VERSION    3                 // Versão do formato do arquivo de estado
+#define EXPORT_MAGIC        0x58454454        // "TDEX": identifica o arquivo de exportação das métricas
+#define EXPORT_VERSION      1                 // Versão do layout do arquivo de exportação
+#define EXPORT_NAME_LEN     32                // Bytes reservados para o nome de cada símbolo
+#define WARMUP_BARS         300               // Barras fechadas usadas no aquecimento de RSI, CCI e MACD
+#define LATENCY_BUCKETS     32                // Faixas dos histogramas de latência (potências de 2 em µs)
+#define LATENCY_REFRESH_MS  1000              // Intervalo entre atualizações da Aba 2 (latências)
+#define LATENCY_COLUMNS     5                 // Colunas da tabela da Aba 2: etapa, p50, p99, máx, amostras
+#define LATENCY_GRID_CELLS  ((TD_STAGE_COUNT + 1) * LATENCY_COLUMNS) // Rótulos da tabela (cabeçalho + uma linha por etapa)
+#define LATENCY_INFO_LINES  4                 // Linhas da Aba 2 abaixo da tabela (símbolo mais lento e contadores)
+#define SPREAD_BINS         256               // Faixas do histograma de spread (em ticks; a última acumula os maiores)
+#define RELVOL_MAGIC        0x56524454        // "TDRV": identifica os arquivos da média de volume por minuto
+#define RELVOL_VERSION      2                 // Versão desses arquivos (2: só sessões completas na média)
+#define RELVOL_MINUTES      1440              // Minutos do dia (posições da média por minuto)
+#define RELVOL_BUILDS_PER_FRAME 1             // Médias montadas a partir do histórico M1 por frame
+#define SWING_MAX_PIVOTS    8                 // Topos/fundos guardados por símbolo na estrutura do PriceAction
+#define SELFCHECK_BARS      400               // Barras sintéticas reproduzidas na verificação incremental x reconstrução
+#define SELFCHECK_TOLERANCE 1e-9              // Maior diferença relativa aceita entre dois cálculos do mesmo valor
+
+//--- Origem dos ticks que alimentam os cálculos e o painel
+enum ENUM_TD_TICK_SOURCE
+{
+   TICK_SOURCE_LIVE,                  // Terminal (CopyTicks)
+   TICK_SOURCE_REPLAY,                // Arquivo gravado com TickRecordFile
+   TICK_SOURCE_SYNTHETIC              // Gerador sintético (SyntheticSymbols / SyntheticTicksPerSec)
+};
+
+//--- Macros de log: o nível é testado antes de montar o texto da mensagem
+#ifdef TD_DEBUG_LOG
+   #define LOG_DEBUG(msg)   do { if(LogLevel <= TD_LOG_DEBUG) LogWrite(TD_LOG_DEBUG, msg); } while(false)
+#else
+   #define LOG_DEBUG(msg)
+#endif
+
+//--- Medições de latência: PROBE_BEGIN marca o início; PROBE_END registra a duração da etapa
+//--- e PROBE_SYMBOL a do recálculo de um símbolo. Removidas por completo com TD_NO_LATENCY.
+#ifdef TD_NO_LATENCY
+   #define PROBE_BEGIN(var)
+   #define PROBE_END(stage, var)
+   #define PROBE_SYMBOL(i, var)
+#else
+   #define PROBE_BEGIN(var)         ulong var = GetMicrosecondCount()
+   #define PROBE_END(stage, var)    LatencyRecord(stageLatency[stage], GetMicrosecondCount() - var)
+   #define PROBE_SYMBOL(i, var)     LatencyRecord(symbolLatency[i], GetMicrosecondCount() - var)
+#endif
+
+#ifdef TD_SCALAR_KERNELS
+   #define KERNEL_VECTORIZED false
+#else
+   #define KERNEL_VECTORIZED true
+#endif
+#define LOG_INFO(msg)       do { if(LogLevel <= TD_LOG_INFO) LogWrite(TD_LOG_INFO, msg); } while(false)
+#define LOG_WARN(msg)       do { if(LogLevel <= TD_LOG_WARN) LogWrite(TD_LOG_WARN, msg); } while(false)
+#define LOG_ERROR(msg)      do { if(LogLevel <= TD_LOG_ERROR) LogWrite(TD_LOG_ERROR, msg); } while(false)
+
 //--- Definições de layout e dimensionamento do painel
 #define COL_WIDTH           100               // Largura padrão para colunas de dados dos ativos
 #define LABEL_COL_WIDTH     120               // Largura para a primeira coluna, que contém os rótulos (Status, Score, etc.)
@@ -48,6 +148,31 @@ input bool ShowSpread = true;         // Exibir/Ocultar a linha de Spread
 input bool ShowMAs = true;            // Exibir/Ocultar o bloco de Médias Móveis
 input bool ShowIndicators = true;     // Exibir/Ocultar o bloco de Indicadores Técnicos
 input bool ShowResults = true;        // Exibir/Ocultar o bloco de Resultados
+input ENUM_TD_LOG_LEVEL LogLevel = TD_LOG_INFO; // Nível mínimo das mensagens enviadas ao diário (Experts)
+input bool UseCanvasRenderer = false; // Desenhar a tabela da Aba 1 em um único bitmap (menos objetos no gráfico)
+input int FrameIntervalMs = 100;      // Intervalo entre frames de atualização do painel (ms)
+input int FrameBudgetMs = 50;         // Tempo máximo de cálculo por frame (ms); o restante fica para o próximo frame
+input ENUM_TIMEFRAMES MATimeframe = PERIOD_CURRENT; // Tempo gráfico das médias, Bollinger, ATR e indicadores
+input ENUM_MA_METHOD MAMethod = MODE_SMA; // Tipo das médias móveis (MODE_SMA ou MODE_EMA)
+input int MAPeriod = 20;              // Período da linha "MA"
+input ENUM_TIMEFRAMES MAHigherTF = PERIOD_H1; // Tempo gráfico maior da linha "MA Higher TF"
+input int MAHigherTFPeriod = 20;      // Período da linha "MA Higher TF"
+input int BBPeriod = 20;              // Período das Bandas de Bollinger
+input double BBDeviation = 2.0;       // Desvios-padrão das Bandas de Bollinger
+input int ATRPeriod = 14;             // Período do ATR
+input int DeltaWindowMinutes = 5;     // Janela móvel do Delta (minutos), usada na cor da linha
+input int RelVolumeDays = 20;         // Dias de histórico M1 na média de volume por minuto (linha Volume)
+input int SwingStrength = 2;          // Barras de cada lado que confirmam um topo/fundo (linha PriceAction)
+input ENUM_TD_TICK_SOURCE TickSource = TICK_SOURCE_LIVE; // Origem dos ticks (ao vivo, reprodução ou sintético)
+input string TickRecordFile = "";     // Grava os ticks processados neste arquivo (pasta Files); vazio = não grava
+input string TickReplayFile = "";     // Arquivo reproduzido quando TickSource = reprodução
+input double ReplaySpeed = 1.0;       // Velocidade da reprodução/geração (1 = tempo real)
+input int SyntheticSymbols = 100;     // Número de símbolos do gerador sintético
+input int SyntheticTicksPerSec = 10000; // Ticks por segundo do gerador sintético (somando todos os símbolos)
+input bool RunBenchmark = false;      // Mede o custo do painel na inicialização, variando o número de símbolos
+input string BenchmarkFile = "td_benchmark.csv"; // Arquivo CSV com os resultados do benchmark (pasta Files)
+input string SnapshotFile = "td_snapshot.bin"; // Estado salvo ao remover o EA e restaurado ao anexá-lo (vazio = desativado)
+input string ExportFile = "";         // Exporta as métricas a cada frame para este arquivo (pasta comum); vazio = desativado
 
 //--- Variáveis Globais
 string symbolArray[];                 // Array que armazenará os nomes dos símbolos a serem monitorados
@@ -57,6 +182,573 @@ bool initialHiddenMode = true;        // Modo de ocultação inicial para objeto
 int activeTab = 1;                    // Controla qual aba está atualmente ativa (1 ou 2)
 int panelWidth = 0;                   // Largura total do painel, calculada dinamicamente
 int panelHeight = 0;                  // Altura total do painel, calculada dinamicamente
+int chartSymbolIndex = -1;            // Índice do símbolo do gráfico em symbolArray (-1 se não monitorado)
+CHashMap<string,int> symbolIndexMap;  // Nome do símbolo -> índice em symbolArray (eventos por nome, como OnBookEvent)
+
+//--- Buffer circular de mensagens de log (descarregado uma vez por ciclo do timer)
+string logRing[LOG_RING_SIZE];        // Mensagens pendentes, já formatadas
+int logHead = 0;                      // Posição da mensagem mais antiga
+int logCount = 0;                     // Número de mensagens pendentes
+ulong logDropped = 0;                 // Mensagens descartadas por buffer cheio desde o último descarregamento
+
+//--- Agendador de atualização por timer (um recálculo por símbolo por frame)
+long lastTickMsc[];                   // time_msc do último tick visto de cada símbolo
+bool symbolPending[];                 // Se o símbolo tem tick novo aguardando recálculo
+int schedCursor = 0;                  // Próximo símbolo da fila em rodízio
+ulong ticksCoalesced = 0;             // Ticks absorvidos por um recálculo já pendente
+ulong symbolsDeferred = 0;            // Recálculos adiados por estouro do orçamento do frame
+ulong symbolsRecomputed = 0;          // Recálculos de símbolo feitos pelo agendador
+ulong frameNumber = 0;                // Contador de frames (identifica o frame atual)
+ulong tickReadsTruncated = 0;         // Leituras de ticks cortadas em TICKS_PER_CALL (o restante fica para o frame seguinte)
+
+//--- Etapas medidas do caminho tick -> cálculo -> diff -> desenho
+enum ENUM_TD_STAGE
+{
+   TD_STAGE_TICK,                     // Leitura dos ticks e motores de ticks (por símbolo)
+   TD_STAGE_COMPUTE,                  // Recálculo das linhas do símbolo (por símbolo)
+   TD_STAGE_DIFF,                     // Armazém de métricas -> células visíveis (SyncVisibleCells)
+   TD_STAGE_RENDER,                   // Envio das células alteradas e redesenho (FlushPanel)
+   TD_STAGE_FRAME,                    // Frame completo (UpdatePanelValues)
+   TD_STAGE_COUNT
+};
+
+//--- Histograma de latência com faixas fixas: a faixa b guarda durações de b bits (até 2^b - 1 µs)
+struct LatencyHistogram
+{
+   long  buckets[LATENCY_BUCKETS];
+   long  count;                       // Amostras registradas
+   ulong max;                         // Maior duração registrada (µs)
+};
+
+LatencyHistogram stageLatency[TD_STAGE_COUNT]; // Latência de cada etapa
+LatencyHistogram symbolLatency[];     // Latência do recálculo completo (ticks + linhas) de cada símbolo
+string latencyTexts[];                // Último texto enviado a cada rótulo da Aba 2
+ulong latencyRefreshAt = 0;           // Instante (µs) da última atualização da Aba 2
+
+//--- Cache compartilhado de barras por (símbolo, tempo gráfico)
+struct BarSeries
+{
+   string          symbol;
+   ENUM_TIMEFRAMES tf;
+   MqlRates        rates[];           // Barras em buffer circular (a mais recente, em formação, em head)
+   int             capacity;          // Tamanho do buffer (maior profundidade pedida pelos leitores)
+   int             head;              // Posição da barra em formação
+   int             count;             // Barras válidas no buffer
+   ulong           syncedFrame;       // Frame da última sincronização com o terminal
+   long            closedCount;       // Barras fechadas desde a última recarga (leitores detectam barras novas)
+   int             reloadVersion;     // Incrementado a cada recarga completa (leitores devem se reconstruir)
+   bool            needsReload;       // Se a próxima sincronização deve recarregar todo o histórico
+};
+
+BarSeries barCache[];                 // Séries de barras em cache
+CHashMap<string,int> barCacheIndex;   // "símbolo|tempo gráfico" -> índice em barCache
+ulong barCacheHits = 0;               // Leituras atendidas pelo cache (sem cópia do terminal)
+ulong barCacheMisses = 0;             // Cópias feitas no terminal (CopyRates)
+ulong barCacheReportAt = 0;           // Instante (µs) do último relatório do cache
+
+//--- Janela circular de tamanho fixo com soma e soma dos quadrados (SMA e Bollinger em O(1))
+struct RollingWindow
+{
+   double buf[];                      // Valores da janela (o mais recente em head)
+   int    size;                       // Capacidade da janela (período)
+   int    head;                       // Posição do valor mais recente
+   int    count;                      // Número de valores válidos (até size)
+   double sum;                        // Soma dos valores da janela
+   double sumSq;                      // Soma dos quadrados dos valores da janela
+};
+
+//--- Média móvel incremental (SMA pela janela, EMA pelo valor da última barra fechada)
+struct MovingAverage
+{
+   int           period;
+   RollingWindow win;                 // Fechamentos das últimas `period` barras (inclui a barra em formação)
+   double        emaClosed;           // EMA na última barra fechada
+   bool          emaSeeded;           // Se emaClosed já foi inicializada
+   double        value;               // Valor atual (inclui a barra em formação)
+};
+
+//--- ATR de Wilder incremental
+struct AtrState
+{
+   int    period;
+   double atrClosed;                  // ATR na última barra fechada
+   double prevClose;                  // Fechamento da última barra fechada
+   int    seedCount;                  // Barras acumuladas na semente (média simples das primeiras TRs)
+   double seedSum;                    // Soma das TRs da semente
+   double value;                      // Valor atual (inclui a barra em formação)
+};
+
+//--- Topo ou fundo confirmado (pivô da estrutura de mercado)
+struct SwingPivot
+{
+   double   price;
+   datetime time;
+   bool     isHigh;
+   bool     broken;                   // Se um fechamento já rompeu o nível
+};
+
+//--- Estrutura de mercado incremental (PriceAction): pivôs confirmados e último rompimento
+struct SwingState
+{
+   int        strength;               // Barras de cada lado que confirmam um pivô
+   double     barHigh[];              // Máximas das últimas 2*strength+1 barras fechadas (circular)
+   double     barLow[];               // Mínimas das mesmas barras
+   datetime   barTime[];              // Abertura das mesmas barras
+   int        barHead;                // Posição da barra fechada mais recente
+   int        barCount;               // Barras válidas na janela
+   long       barSeq;                 // Número de sequência da barra fechada mais recente
+   long       queue[];                // Filas monotônicas da janela: [0, size) máximas, [size, 2*size) mínimas
+   int        queueFirst[2];          // Posição da candidata mais antiga de cada fila
+   int        queueCount[2];          // Candidatas em cada fila
+   SwingPivot pivots[SWING_MAX_PIVOTS]; // Pilha limitada de pivôs (circular, o mais recente em pivotHead)
+   int        pivotHead;              // Posição do pivô mais recente
+   int        pivotCount;             // Pivôs válidos na pilha
+   int        trend;                  // +1 Alta, -1 Baixa, 0 Lateral
+   bool       hasBreak;               // Se já houve rompimento de um pivô
+   double     breakLevel;             // Nível do último pivô rompido
+};
+
+//--- Estado incremental de um símbolo em um tempo gráfico
+struct IndicatorSeries
+{
+   ENUM_TIMEFRAMES tf;
+   bool            ready;             // Se o estado foi construído a partir do histórico
+   datetime        barTime;           // Abertura da barra em formação
+   int             cacheSlot;         // Série de barras em barCache lida por este estado
+   long            seenClosed;        // closedCount do cache já incorporado
+   int             seenReload;        // reloadVersion do cache já incorporada
+   double          close;             // Último preço da barra em formação
+   double          closedClose;       // Fechamento da última barra fechada (valida o estado restaurado)
+   bool            restored;          // Se o estado veio do snapshot e ainda não foi alinhado às barras
+   MovingAverage   ma[];              // Médias móveis calculadas nesta série
+   bool            hasBands;          // Se calcula Bollinger e ATR
+   RollingWindow   bb;                // Janela das Bandas de Bollinger
+   AtrState        atr;
+   SwingState      swing;             // Estrutura de topos e fundos (linha PriceAction)
+};
+
+IndicatorSeries mainSeries[];         // Médias, Bollinger, ATR e PriceAction no tempo gráfico MATimeframe (um por símbolo)
+IndicatorSeries htfSeries[];          // Média do tempo gráfico maior MAHigherTF (um por símbolo)
+
+//--- Handle de indicador compartilhado, identificado por (símbolo, tempo gráfico, indicador, parâmetros)
+struct IndicatorHandle
+{
+   string          symbol;
+   ENUM_TIMEFRAMES tf;
+   ENUM_INDICATOR  type;
+   MqlParam        params[];          // Parâmetros usados em IndicatorCreate
+   int             bufferMask;        // Buffers lidos pelas linhas (bit b = buffer b)
+   int             handle;            // INVALID_HANDLE enquanto não foi criado
+   bool            failed;            // Se a última tentativa de IndicatorCreate falhou
+   int             attempts;          // Tentativas de criação feitas
+   ulong           retryAt;           // Instante (µs) a partir do qual a criação é tentada de novo
+   int             cacheSlot;         // Série de barras usada para detectar barra nova
+   long            seenClosed;        // closedCount do cache na última leitura
+   int             seenReload;        // reloadVersion do cache na última leitura
+   bool            hasValues;         // Se values[] já foi preenchido
+   double          values[];          // [buffer * 2 + (shift - 1)]: barras fechadas 1 e 2 de cada buffer
+};
+
+IndicatorHandle indicatorPool[];      // Handles de todos os indicadores usados pelo painel
+CHashMap<string,int> indicatorPoolIndex; // Chave do indicador -> índice em indicatorPool
+int indicatorPoolPending = 0;         // Primeiro handle do pool ainda não criado (criação em ordem)
+int indicatorPoolFailed = 0;          // Handles com criação falha aguardando nova tentativa
+double indicatorReadBuffer[];         // Buffer reaproveitado por CopyBuffer nas leituras do pool
+
+//--- Handles usados pelas linhas de indicadores de um símbolo (índices em indicatorPool)
+struct SymbolIndicators
+{
+   int adx;
+   int ichimoku;
+   int macd;
+   int rsi;
+   int cci;
+   int sar;
+};
+
+SymbolIndicators symbolIndicators[];  // Indicadores de cada símbolo
+
+//--- Aquecimento de RSI, CCI e MACD calculado sobre o cache de barras enquanto os handles não têm valores
+struct IndicatorWarmup
+{
+   int    cacheSlot;                  // Série de barras (MATimeframe) com WARMUP_BARS barras fechadas
+   long   seenClosed;                 // closedCount do cache no último cálculo
+   int    seenReload;                 // reloadVersion do cache no último cálculo
+   bool   valid;                      // Se os valores abaixo foram calculados
+   double rsi;
+   double cci;
+   double macd;                       // Linha principal do MACD
+   double macdSignal;                 // Linha de sinal do MACD
+};
+
+IndicatorWarmup warmups[];            // Aquecimento de cada símbolo
+
+//--- Identificadores das linhas de dados da Aba 1 (usados para localizar as células de cada símbolo)
+enum ENUM_TD_ROW
+{
+   TD_ROW_STATUS,
+   TD_ROW_ACOES,
+   TD_ROW_SCORE,
+   TD_ROW_PONT,
+   TD_ROW_PRESSAO,
+   TD_ROW_DELTA,
+   TD_ROW_LIQUIDEZ,
+   TD_ROW_SPREAD,
+   TD_ROW_MA,
+   TD_ROW_MA50,
+   TD_ROW_MA100,
+   TD_ROW_MA200,
+   TD_ROW_MA_HTF,
+   TD_ROW_ADX,
+   TD_ROW_ICHIMOKU,
+   TD_ROW_PRICEACTION,
+   TD_ROW_MACD,
+   TD_ROW_RSI,
+   TD_ROW_CCI,
+   TD_ROW_T3,
+   TD_ROW_RIBBON,
+   TD_ROW_BB,
+   TD_ROW_SAR,
+   TD_ROW_ATR,
+   TD_ROW_VOLUME,
+   TD_ROW_RR,
+   TD_ROW_AUTO,
+   TD_ROW_WINLOSS,
+   TD_ROW_RES_ATIVO,
+   TD_ROW_SALDO,
+   TD_ROW_COUNT                       // Total de linhas (não é uma linha real)
+};
+
+//--- Como o valor numérico de uma linha é formatado na célula
+enum ENUM_TD_FORMAT
+{
+   TD_FMT_TEXT,                       // Texto pronto (ícones, estados), definido com SetCellValue
+   TD_FMT_INTEGER,                    // Número arredondado para inteiro
+   TD_FMT_DECIMAL,                    // Número com `digits` casas decimais
+   TD_FMT_PRICE,                      // Preço com as casas decimais do símbolo
+   TD_FMT_COMPACT,                    // Número compacto (1.2k, 3.4M)
+   TD_FMT_CURRENCY                    // Valor em reais (R$ 0.00)
+};
+
+//--- Descrição de uma linha da tabela: a criação, o layout e a formatação são guiados por esta tabela
+struct RowDescriptor
+{
+   string         label;              // Rótulo exibido na coluna de rótulos
+   string         prefix;             // Prefixo dos nomes dos objetos da linha
+   bool           visible;            // Se a linha existe no painel (parâmetros Show*)
+   ENUM_TD_FORMAT format;             // Formatação dos valores numéricos
+   int            digits;             // Casas decimais de TD_FMT_DECIMAL
+};
+
+RowDescriptor rowSchema[TD_ROW_COUNT]; // Uma entrada por linha, na ordem de exibição
+
+//--- Sinais das linhas (+1 alta, -1 baixa, 0 neutro) com carimbo de versão, por (linha, símbolo)
+int rowSignal[];                      // Sinal atual de cada (linha, símbolo), indexado por CellSlot
+uint rowSignalVersion[];              // Versão do sinal: muda apenas quando o sinal muda
+bool rowFeedsScore[TD_ROW_COUNT];     // Linhas declaradas como entradas do Score (ver ResetScoring)
+uint scoreInputVersion[];             // Por símbolo: incrementada quando qualquer entrada do Score muda
+uint scoreSeenVersion[];              // Por símbolo: versão das entradas usada no último cálculo do Score
+int scoreRecomputesFrame = 0;         // Recálculos do Score no último frame
+ulong scoreRecomputes = 0;            // Recálculos do Score desde o último relatório
+ulong scoreSkips = 0;                 // Símbolos cujo Score não precisou ser recalculado, desde o último relatório
+
+//--- Lote do Score: os símbolos a recalcular no frame são reunidos e calculados de uma vez
+#define SCORE_OUT_STRIDE    4                 // Saída por símbolo: score, alta, neutras, baixa
+int scoreFeeds[TD_ROW_COUNT];         // rowFeedsScore como inteiros (entrada do cálculo em lote)
+int scoreBatch[];                     // Símbolos do lote do frame
+double scoreBatchOut[];               // Resultados do lote [k * SCORE_OUT_STRIDE + campo]
+
+//--- Cursor do fluxo de ticks de um símbolo (nenhum tick é processado duas vezes)
+struct TickCursor
+{
+   long   lastMsc;                    // time_msc do último tick processado
+   int    sameMscCount;               // Ticks com time_msc == lastMsc já processados
+   bool   tradeFeed;                  // true em bolsa (ticks de negócio), false em FX (apenas cotações)
+};
+
+//--- Delta de agressão acumulado de um símbolo
+struct DeltaState
+{
+   datetime sessionDay;               // Dia (00:00) da sessão acumulada
+   double   sessionDelta;             // Delta acumulado na sessão
+   double   lastBid;                  // Última cotação de compra (regra bid/ask em FX)
+   double   lastAsk;                  // Última cotação de venda (regra bid/ask em FX)
+   double   lastTrade;                // Preço do último negócio (regra do tick quando não há agressor)
+   int      lastSide;                 // Lado do último negócio classificado (+1 compra, -1 venda)
+   double   bucket[];                 // Delta de cada minuto da janela móvel (circular)
+   long     bucketMinute[];           // Minuto (tempo / 60) de cada balde da janela
+   double   windowDelta;              // Delta da janela móvel, recalculado a cada frame
+};
+
+TickCursor tickCursors[];             // Cursor do fluxo de ticks de cada símbolo
+DeltaState deltaStates[];             // Delta de cada símbolo
+
+//--- Livro de ofertas compacto de um símbolo, atualizado no lugar a cada OnBookEvent
+struct BookState
+{
+   bool   subscribed;                 // Se MarketBookAdd foi aceito para o símbolo
+   bool   changed;                    // Se o livro mudou desde o último frame
+   int    bidLevels;                  // Níveis de compra válidos
+   int    askLevels;                  // Níveis de venda válidos
+   double bidVolume[BOOK_DEPTH];      // Volume de cada nível de compra (0 = melhor oferta)
+   double askVolume[BOOK_DEPTH];      // Volume de cada nível de venda (0 = melhor oferta)
+   double bidWeighted;                // Soma dos volumes de compra ponderados pela profundidade
+   double askWeighted;                // Soma dos volumes de venda ponderados pela profundidade
+};
+
+BookState bookStates[];               // Livro de cada símbolo
+
+//--- Perfil de volume da sessão em níveis de preço (um nível por tick size)
+struct VolumeProfile
+{
+   datetime sessionDay;               // Dia (00:00) da sessão acumulada
+   double   tickSize;                 // Tamanho de cada nível de preço
+   long     baseTick;                 // Preço do nível 0, em ticks (preço / tickSize)
+   double   bins[];                   // Volume negociado em cada nível
+   int      binCount;                 // Níveis alocados em bins[]
+   double   maxVolume;                // Maior volume entre todos os níveis (máximo corrente)
+   int      pocBin;                   // Nível com o maior volume (POC), -1 se vazio
+};
+
+VolumeProfile volumeProfiles[];       // Perfil de volume de cada símbolo
+
+//--- Distribuição do spread na sessão: histograma em ticks com memória fixa (SPREAD_BINS)
+struct SpreadStats
+{
+   datetime sessionDay;               // Dia (00:00) da sessão acumulada
+   double   tickSize;                 // Tamanho do tick usado para converter o spread
+   long     bins[SPREAD_BINS];        // Ticks da sessão com cada spread (em ticks)
+   long     count;                    // Total de ticks na distribuição
+   int      current;                  // Spread do último tick (em ticks), -1 se ainda não houve cotação
+};
+
+SpreadStats spreadStats[];            // Distribuição do spread de cada símbolo
+
+//--- Volume relativo: volume acumulado da sessão sobre a média dos últimos dias no mesmo minuto
+struct RelVolumeState
+{
+   int      cacheSlot;                // Série M1 no cache de barras (-1 = sem histórico, fora do modo ao vivo)
+   datetime baselineDay;              // Sessão para a qual a média foi montada (0 = ainda não montada)
+   int      baselineDays;             // Dias com volume usados na média
+   float    baseline[RELVOL_MINUTES]; // Volume acumulado médio até o fim de cada minuto do dia
+   datetime sessionDay;               // Sessão do volume acumulado abaixo
+   double   sessionVolume;            // Volume das barras M1 já fechadas na sessão
+   long     seenClosed;               // closedCount do cache já somado
+   int      seenReload;               // reloadVersion do cache já somada
+};
+
+RelVolumeState relVolumes[];          // Volume relativo de cada símbolo
+ulong relVolumeBuildFrame = 0;        // Frame das últimas montagens da média
+int relVolumeBuilds = 0;              // Médias montadas nesse frame
+
+//--- Estado da codificação delta dos ticks de um símbolo (gravação e reprodução)
+struct TickCodec
+{
+   long msc;                          // time_msc do tick anterior
+   long bid;                          // Bid anterior, em ticks
+   long ask;                          // Ask anterior, em ticks
+   long last;                         // Last anterior, em ticks
+};
+
+//--- Fila de ticks entregues pela reprodução/gerador e ainda não processados
+struct TickQueue
+{
+   MqlTick ticks[];
+   int     head;                      // Próximo tick a entregar
+   int     count;                     // Ticks na fila
+};
+
+double sourceTickSize[];              // Tick size de cada símbolo (terminal, arquivo ou gerador)
+int sourceDigits[];                   // Casas decimais de cada símbolo
+bool sourceTradeFeed[];               // Se o símbolo tem ticks de negócio
+TickQueue tickQueues[];               // Filas de ticks por símbolo (reprodução e gerador)
+long sourceClockMsc = 0;              // Relógio da reprodução/gerador (time_msc)
+
+int recordHandle = INVALID_HANDLE;    // Arquivo de gravação aberto
+uchar recordBuf[];                    // Bytes codificados ainda não gravados
+int recordLen = 0;                    // Bytes válidos em recordBuf
+TickCodec recordCodec[];              // Estado da codificação por símbolo
+
+int replayHandle = INVALID_HANDLE;    // Arquivo de reprodução aberto
+uchar replayBuf[];                    // Bloco lido do arquivo de reprodução
+int replayLen = 0;                    // Bytes válidos em replayBuf
+int replayPos = 0;                    // Próximo byte a decodificar
+TickCodec replayCodec[];              // Estado da decodificação por símbolo
+bool replayHasNext = false;           // Se replayNext contém um tick já decodificado
+int replayNextSymbol = -1;            // Símbolo do tick em replayNext
+MqlTick replayNext;                   // Próximo tick do arquivo (aguardando o relógio)
+long synthBid[];                      // Bid atual de cada símbolo sintético, em ticks
+
+//--- Resultados do dia de um símbolo (linhas RR, Win/Loss e Res. ativo)
+struct TradeResults
+{
+   double realized;                   // Resultado realizado no dia (lucro + swap + comissão + taxa)
+   int    wins;                       // Saídas com resultado positivo
+   int    losses;                     // Saídas com resultado negativo
+   double grossWin;                   // Soma dos resultados positivos
+   double grossLoss;                  // Soma dos resultados negativos (em módulo)
+   double floating;                   // Resultado aberto das posições do símbolo
+   int    openPositions;              // Posições abertas no símbolo
+};
+
+TradeResults tradeResults[];          // Resultados de cada símbolo
+double resultsRealizedTotal = 0.0;    // Resultado realizado no dia em todos os símbolos da conta
+datetime resultsDay = 0;              // Dia (00:00) acumulado nos resultados
+bool positionsDirty = true;           // Se as posições mudaram e a contagem por símbolo deve ser refeita
+
+//--- Layout do arquivo de exportação (pasta comum dos terminais, little-endian, sem alinhamento):
+//    ExportHeader | ExportSymbol[symbols] | ExportRecord[symbols * rows]
+//    O registro de (linha, símbolo) fica na posição CellSlot(linha, símbolo), que é fixa.
+//    O cabeçalho é regravado com `seq` ímpar antes dos registros e par depois: o leitor lê
+//    `seq`, os registros e `seq` de novo, e descarta a leitura se os dois diferem ou são ímpares.
+struct ExportHeader
+{
+   uint  magic;                       // EXPORT_MAGIC
+   uint  version;                     // EXPORT_VERSION
+   ulong seq;                         // Sequência do frame (ímpar durante a gravação)
+   long  time;                        // Horário do servidor da gravação
+   int   symbols;                     // Número de símbolos
+   int   rows;                        // Linhas por símbolo (TD_ROW_COUNT)
+   int   recordSize;                  // sizeof(ExportRecord)
+   int   reserved;
+};
+
+struct ExportSymbol
+{
+   uchar name[EXPORT_NAME_LEN];       // Nome do símbolo (ANSI, terminado em zero)
+};
+
+struct ExportRecord
+{
+   int    symbol;                     // Índice na tabela de símbolos
+   int    row;                        // ENUM_TD_ROW
+   int    signal;                     // Sinal da linha para o Score (+1, -1, 0)
+   int    flags;                      // Bit 0: `value` é numérico (linhas de texto exportam só o sinal)
+   double value;                      // Valor numérico da métrica
+   ulong  seq;                        // Sequência do frame em que o registro mudou
+   long   time;                       // Horário do servidor em que o registro mudou
+};
+
+int exportHandle = INVALID_HANDLE;    // Arquivo de exportação aberto
+ExportHeader exportHeader;            // Cabeçalho regravado a cada frame
+ExportRecord exportRecords[];         // Cópia de todos os registros, na ordem de CellSlot
+uint exportSeen[];                    // Versão de cada métrica já exportada
+int exportDirty[];                    // Registros alterados no frame, em ordem crescente de posição
+ulong exportSeq = 0;                  // Frames exportados
+
+bool snapshotLoaded = false;          // Se o estado da execução anterior foi restaurado
+ulong initStartUs = 0;                // Início da inicialização (GetMicrosecondCount)
+bool firstFullFrameLogged = false;    // Se o tempo até o primeiro frame completo já foi registrado
+ENUM_TD_TICK_SOURCE tickSource = TICK_SOURCE_LIVE; // Origem em uso (TickSource, ou sintética durante o benchmark)
+
+//--- Contadores de chamadas à API de objetos do gráfico (ver PanelObjectCreate e afins)
+enum ENUM_TD_API
+{
+   TD_API_CREATE,                     // ObjectCreate
+   TD_API_SET_INTEGER,                // ObjectSetInteger
+   TD_API_SET_STRING,                 // ObjectSetString
+   TD_API_REDRAW,                     // ChartRedraw
+   TD_API_RESOURCE,                   // ResourceCreate (renderizador em bitmap)
+   TD_API_COUNT
+};
+
+long apiCalls[TD_API_COUNT];          // Chamadas acumuladas desde o início
+int benchSymbols = 0;                 // Símbolos sintéticos da medição em andamento (0 = fora do benchmark)
+ulong benchBudgetUs = 0;              // Orçamento do frame (µs) durante o benchmark (0 = FrameBudgetMs)
+MqlBookInfo bookBuffer[];             // Buffer reaproveitado por MarketBookGet (sem alocação por evento)
+int bookReserved = 0;                 // Entradas reservadas em bookBuffer (o dobro do maior livro visto)
+double bookWeight[BOOK_DEPTH];        // Peso de cada nível: 1 / (nível + 1)
+
+//--- Retângulo de layout (coordenadas em pixels a partir do canto superior esquerdo do gráfico)
+struct PanelRect
+{
+   int x;
+   int y;
+   int w;
+   int h;
+};
+
+PanelRect layoutTab1Btn;              // Botão da Aba 1
+PanelRect layoutTab2Btn;              // Botão da Aba 2
+PanelRect layoutMinimizeBtn;          // Botão de minimizar/maximizar
+PanelRect layoutGrid;                 // Área da tabela de dados da Aba 1
+PanelRect layoutScrollLeft;           // Metade esquerda do canto da tabela (rola para os símbolos anteriores)
+PanelRect layoutScrollRight;          // Metade direita do canto da tabela (rola para os próximos símbolos)
+
+//--- Modelo-sombra das células: guarda o último texto/cor enviados ao terminal para cada célula
+struct CellState
+{
+   string textObj;                    // Nome pré-calculado do objeto de texto (name + "_Text")
+   string text;                       // Último texto enviado ao terminal
+   color  textColor;                  // Última cor de texto enviada ao terminal
+   string pendingText;                // Texto desejado para o próximo frame
+   color  pendingColor;               // Cor desejada para o próximo frame
+   bool   dirty;                      // Se a célula já está na lista de pendentes
+   bool   onCanvas;                   // Se a célula é desenhada no bitmap em vez de objetos
+   int    x;                          // Posição X da célula no gráfico
+   int    y;                          // Posição Y da célula no gráfico
+   int    width;                      // Largura da célula
+   color  bgColor;                    // Cor de fundo da célula
+   bool   bold;                       // Se o texto é desenhado em negrito
+};
+
+CellState cellStates[];               // Estado de todas as células criadas por CreateCell
+int cellCount = 0;                    // Número de células registradas
+int cellMap[];                        // (linha * visibleColumns + coluna) -> índice em cellStates (-1 se a linha não existe)
+int dirtyCells[];                     // Índices das células alteradas desde o último frame
+int dirtyCount = 0;                   // Número de células pendentes em dirtyCells
+
+//--- Armazém de métricas: matriz (linha x símbolo) guardada por coluna, ou seja, as linhas de um
+//    símbolo são contíguas (ver CellSlot). Inclui os símbolos fora da área visível. Cada valor tem
+//    uma versão; SyncVisibleCells formata e envia às células apenas as versões ainda não exibidas.
+double metricValue[];                 // Valor numérico de cada (linha, símbolo)
+string metricText[];                  // Texto de cada (linha, símbolo) quando metricIsText
+bool metricIsText[];                  // Se o valor atual é um texto pronto (estado, ícone, "...")
+color metricColor[];                  // Cor do texto
+uint metricVersion[];                 // Versão do valor (incrementada a cada mudança)
+uint metricShown[];                   // Versão exibida pela célula da coluna (0 = nunca exibida)
+int visibleColumns = 0;               // Colunas de símbolos com células (as que cabem na largura do gráfico)
+int firstVisibleSymbol = 0;           // Símbolo exibido na primeira coluna
+int headerCells[];                    // Célula com o nome do símbolo de cada coluna
+int headerCornerCell = -1;            // Célula do canto da tabela (faixa exibida e setas de rolagem)
+
+//--- Seções do painel cujos objetos são exibidos/ocultados em conjunto
+enum ENUM_TD_SECTION
+{
+   TD_SEC_HEADER,                     // Fundo, cabeçalho e botões (sempre visíveis)
+   TD_SEC_TAB1,                       // Tabela de dados da Aba 1
+   TD_SEC_TAB2,                       // Conteúdo da Aba 2
+   TD_SEC_COUNT
+};
+
+//--- Registro dos objetos criados pelo painel, agrupados por seção
+struct ObjectList
+{
+   string names[];                    // Nomes dos objetos da seção, na ordem de criação
+   int    count;                      // Número de nomes válidos em names[]
+};
+
+ObjectList sectionObjects[TD_SEC_COUNT]; // Objetos pertencentes a cada seção
+int sectionVisible[TD_SEC_COUNT];     // Visibilidade aplicada a cada seção (-1 = ainda não aplicada)
+ENUM_TD_SECTION buildSection = TD_SEC_HEADER; // Seção que recebe os objetos criados no momento
+
+//--- Renderizador em bitmap da Aba 1 (usado quando UseCanvasRenderer = true)
+#define CANVAS_OBJECT       "TD_GridCanvas"   // Nome do objeto OBJ_BITMAP_LABEL
+#define CANVAS_RESOURCE     "::TD_GridCanvas" // Nome do recurso com os pixels da tabela
+#define GLYPH_CACHE_MAX     1024              // Máximo de glifos em cache antes de esvaziá-lo
+
+uint canvasPixels[];                  // Buffer de pixels da tabela (ARGB)
+int canvasWidth = 0;                  // Largura do buffer em pixels
+int canvasHeight = 0;                 // Altura do buffer em pixels
+bool canvasDirty = false;             // Se o buffer mudou desde o último envio ao terminal
+
+CHashMap<string,int> glyphIndex;      // Chave (caractere|cor|fundo|negrito) -> índice do glifo
+uint glyphPixels[];                   // Pixels de todos os glifos renderizados, concatenados
+int glyphOffset[];                    // Início de cada glifo em glyphPixels
+int glyphWidth[];                     // Largura de cada glifo
+int glyphHeight[];                    // Altura de cada glifo
+int glyphCount = 0;                   // Número de glifos em cache
+int glyphPixelCount = 0;              // Número de pixels usados em glyphPixels
 
 //+------------------------------------------------------------------+
 //| Função de Inicialização do Expert Advisor (EA)                   |
@@ -64,14 +756,39 @@ int panelHeight = 0;                  // Altura total do painel, calculada dinam
 //+------------------------------------------------------------------+
 int OnInit()
 {
-   Print("[0000] DEBUG OnInit iniciado");
+   LOG_DEBUG("[0000] OnInit iniciado");
+   tickSource = TickSource;
+   
+   // Mede o painel com símbolos sintéticos antes de montar o painel real
+   if(RunBenchmark)
+      RunPanelBenchmark();
+   
    // 1. Processa a string de entrada com os símbolos e os armazena no array global
    ProcessSymbols();
+   ResetRowSchema(ShowRowsMask());
+   ResetMetricStore();
+   ResetScheduler();
+   LatencyReset();
+   ResetBarCache();
+   ResetIndicatorSeries();
+   ResetIndicatorPool();
+   ResetScoring();
+   ResetTickStreams();
+   ResetRelVolume();
+   ResetResults();
+   SubscribeBooks();
+   RecordOpen();
+   ExportOpen();
+   
+   // Restaura o estado salvo na última execução; só o intervalo desde então é recalculado
+   snapshotLoaded = SnapshotLoad();
+   initStartUs = GetMicrosecondCount();
+   firstFullFrameLogged = false;
    
    // 2. Calcula as dimensões do painel com base nos itens que serão exibidos
    CalculatePanelSize();
    
-   Print("[0001] activeTab inicial: ", activeTab);
+   LOG_DEBUG("[0001] activeTab inicial: " + IntegerToString(activeTab));
    
    // Define a aba 2 como a aba inicial a ser exibida
    activeTab = 2; 
@@ -79,7 +796,13 @@ int OnInit()
    // 3. Cria todos os objetos gráficos que compõem o painel
    CreatePanel();
    
-   Print("003 - DEBUG [OnInit] Painel criado. Aba ativa: ", activeTab);
+   LOG_INFO("[0006] Painel criado com " + IntegerToString(totalSymbols) + " ativos. Aba ativa: " + IntegerToString(activeTab));
+   
+   // 4. Inicia o timer que conduz os frames de atualização de todos os símbolos
+   EventSetMillisecondTimer(MathMax(FrameIntervalMs, 10));
+   
+   // Descarrega as mensagens da inicialização sem esperar o primeiro frame
+   LogFlush();
    
    return(INIT_SUCCEEDED); // Retorna sucesso na inicialização
 }
@@ -90,9 +813,17 @@ int OnInit()
 //+------------------------------------------------------------------+
 void ProcessSymbols()
 {
-   // Divide a string `SymbolsToMonitor` usando a vírgula como delimitador
-   StringSplit(SymbolsToMonitor, ',', symbolArray);
-   totalSymbols = ArraySize(symbolArray);
+   // Na reprodução os símbolos vêm do arquivo; no gerador sintético, são criados
+   if(tickSource == TICK_SOURCE_REPLAY && ReplayOpen())
+      totalSymbols = ArraySize(symbolArray);
+   else if(tickSource == TICK_SOURCE_SYNTHETIC)
+      SyntheticSymbolsCreate(benchSymbols > 0 ? benchSymbols : SyntheticSymbols);
+   else
+   {
+      // Divide a string `SymbolsToMonitor` usando a vírgula como delimitador
+      StringSplit(SymbolsToMonitor, ',', symbolArray);
+      totalSymbols = ArraySize(symbolArray);
+   }
    
    // Se nenhum símbolo for fornecido, usa o símbolo do gráfico atual como padrão
    if(totalSymbols == 0)
@@ -100,6 +831,46 @@ void ProcessSymbols()
      symbolArray[0] = Symbol();
      totalSymbols = 1;
    }
+   
+   // Propriedades dos símbolos ao vivo (na reprodução e no gerador já foram preenchidas)
+   if(tickSource == TICK_SOURCE_LIVE || ArraySize(sourceTickSize) != totalSymbols)
+      LoadSymbolProperties();
+   
+   // Localiza o símbolo do gráfico, cujo OnTick apenas sinaliza um recálculo pendente,
+   // e indexa os nomes para os eventos que chegam por símbolo
+   chartSymbolIndex = -1;
+   symbolIndexMap.Clear();
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      if(symbolArray[i] == Symbol() && chartSymbolIndex < 0) chartSymbolIndex = i;
+      symbolIndexMap.TrySetValue(symbolArray[i], i);
+   }
+}
+
+/**
+ * @brief Retorna o índice de um símbolo em symbolArray, ou -1 se não for monitorado.
+ */
+int SymbolIndex(string symbol)
+{
+   int i;
+   return symbolIndexMap.TryGetValue(symbol, i) ? i : -1;
+}
+
+/**
+ * @brief Prepara o estado do agendador para a lista atual de símbolos.
+ *        Todos os símbolos começam pendentes para que o primeiro frame preencha o painel.
+ */
+void ResetScheduler()
+{
+   ArrayResize(lastTickMsc, totalSymbols);
+   ArrayResize(symbolPending, totalSymbols);
+   ArrayInitialize(lastTickMsc, 0);
+   ArrayInitialize(symbolPending, true);
+   schedCursor = 0;
+   ticksCoalesced = 0;
+   symbolsDeferred = 0;
+   symbolsRecomputed = 0;
+   tickReadsTruncated = 0;
 }
 
 //+------------------------------------------------------------------+
@@ -110,26 +881,60 @@ void CalculatePanelSize()
 {
    int rows = 1; // Começa com 1 para a linha de cabeçalho dos símbolos
    
-   // Adiciona uma linha para cada seção que está habilitada nos parâmetros de entrada
-   if(ShowStatus) rows++;
-   if(ShowAcoes) rows++;
-   if(ShowScore) rows++;
-   if(ShowPontuation) rows++;
-   if(ShowPressaoDOM) rows++;
-   if(ShowDelta) rows++;
-   if(ShowLiquidity) rows++;
-   if(ShowSpread) rows++;
-   if(ShowMAs) rows += 5;         // 5 linhas para as médias móveis
-   if(ShowIndicators) rows += 11; // 11 linhas para os indicadores
-   if(ShowResults) rows += 5;     // 5 linhas para os resultados
-   
-   // Calcula a largura: margem + coluna de rótulos + (largura da coluna * número de símbolos) + margem
-   panelWidth = MARGIN + LABEL_COL_WIDTH + (COL_WIDTH * totalSymbols) + MARGIN;
+   // Adiciona uma linha para cada linha habilitada na tabela de linhas
+   for(int row = 0; row < TD_ROW_COUNT; row++)
+      if(rowSchema[row].visible) rows++;
+   
+   // Só as colunas que cabem no gráfico recebem células; as demais são alcançadas rolando a tabela
+   visibleColumns = FitColumns();
+   firstVisibleSymbol = MathMax(0, MathMin(firstVisibleSymbol, totalSymbols - visibleColumns));
+   
+   // Calcula a largura: margem + coluna de rótulos + (largura da coluna * colunas visíveis) + margem
+   panelWidth = MARGIN + LABEL_COL_WIDTH + (COL_WIDTH * visibleColumns) + MARGIN;
    // Calcula a altura: altura do cabeçalho + (altura da linha * número de linhas) + margem
    panelHeight = HEADER_HEIGHT + (ROW_HEIGHT * rows) + MARGIN;
    
    // Garante uma altura mínima para o painel não ficar muito pequeno
    if (panelHeight < 150) panelHeight = 150; 
+   
+   // Layout dos elementos clicáveis do cabeçalho e da área da tabela.
+   // É usado tanto na criação dos objetos quanto no teste de clique do modo bitmap.
+   SetRect(layoutTab1Btn, MARGIN + 5, MARGIN + 5, 60, 20);
+   SetRect(layoutTab2Btn, MARGIN + 70, MARGIN + 5, 60, 20);
+   SetRect(layoutMinimizeBtn, panelWidth - MARGIN - 30, MARGIN + 5, 30, 20);
+   SetRect(layoutGrid, MARGIN, MARGIN + HEADER_HEIGHT, LABEL_COL_WIDTH + (COL_WIDTH * visibleColumns), ROW_HEIGHT * rows);
+   SetRect(layoutScrollLeft, MARGIN, MARGIN + HEADER_HEIGHT, LABEL_COL_WIDTH / 2, ROW_HEIGHT);
+   SetRect(layoutScrollRight, MARGIN + LABEL_COL_WIDTH / 2, MARGIN + HEADER_HEIGHT, LABEL_COL_WIDTH / 2, ROW_HEIGHT);
+}
+
+/**
+ * @brief Número de colunas de símbolos que cabem na largura atual do gráfico.
+ */
+int FitColumns()
+{
+   int chartWidth = (int)ChartGetInteger(0, CHART_WIDTH_IN_PIXELS);
+   if(chartWidth <= 0) return totalSymbols; // Sem gráfico visível (ex.: testador): todas as colunas
+   int fit = (chartWidth - (2*MARGIN) - LABEL_COL_WIDTH) / COL_WIDTH;
+   return MathMax(1, MathMin(fit, totalSymbols));
+}
+
+/**
+ * @brief Preenche um retângulo de layout.
+ */
+void SetRect(PanelRect &r, int x, int y, int w, int h)
+{
+   r.x = x;
+   r.y = y;
+   r.w = w;
+   r.h = h;
+}
+
+/**
+ * @brief Verifica se um ponto (em pixels do gráfico) está dentro de um retângulo de layout.
+ */
+bool PointInRect(const PanelRect &r, int px, int py)
+{
+   return px >= r.x && px < r.x + r.w && py >= r.y && py < r.y + r.h;
 }
 
 //+------------------------------------------------------------------+
@@ -137,24 +942,31 @@ void CalculatePanelSize()
 //+------------------------------------------------------------------+
 void CreatePanel()
 {
-   Print("[0002] DEBUG Criando painel completo...");
+   LOG_DEBUG("[0002] Criando painel completo...");
+   // Zera o modelo-sombra e o registro de objetos antes de criar o novo painel
+   ResetCellModel();
+   ResetObjectRegistry();
+   
    // Cria o retângulo de fundo principal do painel
    CreateRectLabel("TD_MainBg", MARGIN, MARGIN, panelWidth - (2*MARGIN), panelHeight - (2*MARGIN), clrDarkBg, clrGridLines, false);
    
    // Cria o cabeçalho, que inclui o título e os botões das abas
    CreateHeader();
    
-   Print("[0003] Criando Tab 1...");
+   LOG_DEBUG("[0003] Criando Tab 1...");
    // Cria todos os objetos da primeira aba (inicialmente ocultos)
    CreateTab1();
    
-   Print("[0004] Criando Tab 2...");
+   LOG_DEBUG("[0004] Criando Tab 2...");
    // Cria todos os objetos da segunda aba (inicialmente ocultos)
-   //  CreateTab2();
+   CreateTab2();
    
-   Print("[0005] Chamando SwitchTab com activeTab=", activeTab);
+   LOG_DEBUG("[0005] Chamando SwitchTab com activeTab=" + IntegerToString(activeTab));
    // Controla a visibilidade para mostrar apenas a aba ativa
    SwitchTab(activeTab);
+   
+   // Primeiro frame: pinta o bitmap da tabela (modo UseCanvasRenderer) e redesenha o gráfico
+   FlushPanel();
 }
 
 //+------------------------------------------------------------------+
@@ -170,16 +982,16 @@ void CreateHeader()
    // Fundo do cabeçalho
    CreateRectLabel("TD_HeaderBg", x, y, panelWidth - (2*MARGIN), HEADER_HEIGHT, clrDarkBg, clrGridLines);
    
-   // Botões para alternar entre as abas
-   CreateTabButton("TD_Tab1", "Guia 1", x + 5, y + 5, 60, 20, activeTab == 1);
-   CreateTabButton("TD_Tab2", "Guia 2", x + 70, y + 5, 60, 20, activeTab == 2);
+   // Botões para alternar entre as abas (posições vindas do layout calculado em CalculatePanelSize)
+   CreateTabButton("TD_Tab1", "Guia 1", layoutTab1Btn.x, layoutTab1Btn.y, layoutTab1Btn.w, layoutTab1Btn.h, activeTab == 1);
+   CreateTabButton("TD_Tab2", "Guia 2", layoutTab2Btn.x, layoutTab2Btn.y, layoutTab2Btn.w, layoutTab2Btn.h, activeTab == 2);
    
    // Título do painel
    CreateLabel("TD_Title", "Detector de Tendência", x + 140, y + 5, clrHeaderText, HEADER_FONT_SIZE, "Arial", true);
    
    // Botão de minimizar/maximizar (o ícone muda dependendo do estado)
-   CreateLabel("TD_MinimizeBtn", panelMinimized ? "[▲]" : "[▼]", x + panelWidth - (2*MARGIN) - 30, y + 5, clrHeaderText, HEADER_FONT_SIZE);
-   ObjectSetInteger(0, "TD_MinimizeBtn", OBJPROP_SELECTABLE, true); // Torna o botão clicável
+   CreateLabel("TD_MinimizeBtn", panelMinimized ? "[▲]" : "[▼]", layoutMinimizeBtn.x, layoutMinimizeBtn.y, clrHeaderText, HEADER_FONT_SIZE);
+   PanelSetInteger("TD_MinimizeBtn", OBJPROP_SELECTABLE, true); // Torna o botão clicável
 }
 
 //+------------------------------------------------------------------+
@@ -192,63 +1004,24 @@ void CreateTab1()
    int y = MARGIN + HEADER_HEIGHT; // Posição inicial Y abaixo do cabeçalho
    int rowIndex = 0; // Contador para a posição vertical de cada linha
    
+   // Todos os objetos criados a partir daqui pertencem à Aba 1
+   buildSection = TD_SEC_TAB1;
+   
+   // No modo bitmap, a tabela inteira é um único objeto; as células apenas registram sua geometria
+   if(UseCanvasRenderer)
+      CanvasCreate();
+   
    // Cria o cabeçalho da tabela com os nomes dos símbolos
    CreateTableHeader(x, y + (rowIndex++ * ROW_HEIGHT));
    
-   // Cria cada linha da tabela condicionalmente, com base nas configurações de entrada
-   if(ShowStatus)
-      CreateStatusRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowAcoes)
-      CreateAcoesRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowScore)
-      CreateScoreRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowPontuation)
-      CreatePontuationRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowPressaoDOM)
-      CreatePressaoDOMRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowDelta)
-      CreateDeltaRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowLiquidity)
-      CreateLiquidityRow(x, y + (rowIndex++ * ROW_HEIGHT));
-   if(ShowSpread)
-      CreateSpreadRow(x, y + (rowIndex++ * ROW_HEIGHT));
-      
-   // Bloco para criar as linhas das Médias Móveis
-   if(ShowMAs)
-   {
-      CreateMARow(x, y + (rowIndex++ * ROW_HEIGHT), "MA");
-      CreateMARow(x, y + (rowIndex++ * ROW_HEIGHT), "MA50");
-      CreateMARow(x, y + (rowIndex++ * ROW_HEIGHT), "MA100");
-      CreateMARow(x, y + (rowIndex++ * ROW_HEIGHT), "MA200");
-      CreateMARow(x, y + (rowIndex++ * ROW_HEIGHT), "MA Higher TF");
-   }
-   
-   // Bloco para criar as linhas dos Indicadores
-   if(ShowIndicators)
+   // Cria as linhas habilitadas, na ordem da tabela de linhas
+   for(int row = 0; row < TD_ROW_COUNT; row++)
    {
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "ADX");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "Ichimoku");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "PriceAction");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "MACD", true);
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "RSI");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "CCI");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "T3", true);
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "Ribbon", true);
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "BB");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "SAR");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "ATR");
-      CreateIndicatorRow(x, y + (rowIndex++ * ROW_HEIGHT), "Volume");
+      if(rowSchema[row].visible)
+         CreateRow((ENUM_TD_ROW)row, x, y + (rowIndex++ * ROW_HEIGHT));
    }
    
-   // Bloco para criar as linhas de Resultados
-   if(ShowResults)
-   {
-      CreateResultRow(x, y + (rowIndex++ * ROW_HEIGHT), "RR");
-      CreateResultRow(x, y + (rowIndex++ * ROW_HEIGHT), "Auto", true);
-      CreateResultRow(x, y + (rowIndex++ * ROW_HEIGHT), "Win/Loss", true);
-      CreateResultRow(x, y + (rowIndex++ * ROW_HEIGHT), "Res. ativo", false, true);
-      CreateResultRow(x, y + (rowIndex++ * ROW_HEIGHT), "Saldo Geral L/P:", false, true);
-   }
+   buildSection = TD_SEC_HEADER;
 }
 
 //+------------------------------------------------------------------+
@@ -256,335 +1029,695 @@ void CreateTab1()
 //+------------------------------------------------------------------+
 void CreateTableHeader(int x, int y)
 {
-   // Cria uma célula vazia no canto superior esquerdo
-   CreateCell("TD_Header_Label", x, y, " ", clrHeaderText, clrActiveTab, true, LABEL_COL_WIDTH, true);
+   // Célula do canto superior esquerdo: mostra a faixa de símbolos exibida quando a tabela rola
+   headerCornerCell = CreateCell("TD_Header_Label", x, y, ScrollRangeText(), clrHeaderText, clrActiveTab, true, LABEL_COL_WIDTH, true);
    
-   // Itera sobre todos os símbolos e cria uma célula de cabeçalho para cada um
-   for(int i = 0; i < totalSymbols; i++)
+   // Cria uma célula de cabeçalho para cada coluna visível
+   ArrayResize(headerCells, visibleColumns);
+   for(int c = 0; c < visibleColumns; c++)
    {
-     CreateCell("TD_Header_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 symbolArray[i], clrHeaderText, clrHeaderSymbols, true, COL_WIDTH, true);
+     headerCells[c] = CreateCell("TD_Header_" + IntegerToString(c), x + LABEL_COL_WIDTH + (c * COL_WIDTH), y, 
+                 symbolArray[firstVisibleSymbol + c], clrHeaderText, clrHeaderSymbols, true, COL_WIDTH, true);
    }
 }
 
-//+------------------------------------------------------------------+
-//| Cria a linha de "Status" na tabela. (Função de exemplo)          |
-//+------------------------------------------------------------------+
-void CreateStatusRow(int x, int y)
+/**
+ * @brief Cria uma linha da tabela: a célula do rótulo e uma célula por coluna visível,
+ *        já com o valor guardado do símbolo da coluna.
+ * @param row Linha da tabela.
+ * @param x   Posição X da tabela.
+ * @param y   Posição Y da linha.
+ */
+void CreateRow(ENUM_TD_ROW row, int x, int y)
 {
-   CreateCell("TD_Status_Label", x, y, "Status", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
+   CreateCell(rowSchema[row].prefix + "Label", x, y, rowSchema[row].label, clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
+   for(int c = 0; c < visibleColumns; c++)
    {
-      string value = (i % 2 == 0) ? "✅" : "⚠️"; // Lógica de exemplo para alternar ícones
-      CreateCell("TD_Status_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 value, clrNormalText, clrHighlightBg, false, COL_WIDTH, true);
+      int i = firstVisibleSymbol + c;
+      int slot = CellSlot(row, i);
+      cellMap[ViewSlot(row, c)] = CreateCell(rowSchema[row].prefix + IntegerToString(c), x + LABEL_COL_WIDTH + (c * COL_WIDTH), y,
+                                             FormatMetric(row, i), metricColor[slot], clrHighlightBg, false, COL_WIDTH);
+      metricShown[slot] = metricVersion[slot];
    }
 }
 
 //+------------------------------------------------------------------+
-//| Cria a linha de "Ações" na tabela. (Função de exemplo)           |
+//| Cria o conteúdo da segunda aba: latência de cada etapa do frame. |
+//| Os objetos usam o prefixo TD_Lat_ ("TD_Tab2_Bg" é o fundo do     |
+//| botão da aba, usado por SwitchTab e pelo clique em OnChartEvent).|
 //+------------------------------------------------------------------+
-void CreateAcoesRow(int x, int y)
+void CreateTab2()
 {
-   CreateCell("TD_Acoes_Label", x, y, "Ações", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
+   int x = MARGIN;
+   int y = MARGIN + HEADER_HEIGHT;
+
+   // Todos os objetos criados a partir daqui pertencem à Aba 2
+   buildSection = TD_SEC_TAB2;
+
+   // Cria o fundo da aba 2 (inicialmente oculto)
+   CreateRectLabel("TD_Lat_Bg", x, y, panelWidth - (2*MARGIN), panelHeight - HEADER_HEIGHT - MARGIN - 5, clrDarkBg, clrGridLines, true);
+
+   LOG_DEBUG("[0010] CreateTab2 chamada. Criando elementos da aba 2 como ocultos");
+
+   // Tabela de etapas (cabeçalho + uma linha por etapa) e as linhas de contadores abaixo dela
+   ArrayResize(latencyTexts, LatencyLabelCount());
+   for(int k = 0; k < ArraySize(latencyTexts); k++)
    {
-      string value = (i % 3 == 0) ? "▲ ▼ 🔴" : "▲ ▼ ⚪"; // Lógica de exemplo para alternar ícones
-      CreateCell("TD_Acoes_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 value, clrNormalText, clrHighlightBg, false, COL_WIDTH, true);
+      int row = (k < LATENCY_GRID_CELLS) ? k / LATENCY_COLUMNS : TD_STAGE_COUNT + 2 + (k - LATENCY_GRID_CELLS);
+      int col = (k < LATENCY_GRID_CELLS) ? k % LATENCY_COLUMNS : 0;
+      latencyTexts[k] = LatencyLabelText(k);
+      CreateLabel("TD_Lat_" + IntegerToString(k), latencyTexts[k], x + 10 + col * 80, y + 10 + row * ROW_HEIGHT,
+                  (row == 0 || col == 0) ? clrHeaderText : clrNormalText, FONT_SIZE, "Arial", false, true);
    }
+   latencyRefreshAt = GetMicrosecondCount();
+
+   buildSection = TD_SEC_HEADER;
 }
 
+
 //+------------------------------------------------------------------+
-//| Cria a linha de "Score" na tabela. (Função de exemplo)           |
+//| Funções Auxiliares para Criação de Objetos Gráficos              |
 //+------------------------------------------------------------------+
-void CreateScoreRow(int x, int y)
+
+/**
+ * @brief Cria um rótulo retangular no gráfico.
+ * @param name          Nome do objeto (deve ser único).
+ * @param x             Posição X no gráfico.
+ * @param y             Posição Y no gráfico.
+ * @param width         Largura do retângulo.
+ * @param height        Altura do retângulo.
+ * @param bgColor       Cor de fundo.
+ * @param borderColor   Cor da borda.
+ * @param hidden        Se o objeto deve ser criado oculto (default: true).
+ */
+void CreateRectLabel(string name, int x, int y, int width, int height, color bgColor, color borderColor, bool hidden=true)
 {
-   CreateCell("TD_Score_Label", x, y, "SCORE", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
-   {
-      string value = (i % 2 == 0) ? "🟢 89" : "🔴 45"; // Lógica de exemplo
-      color textColor = (i % 2 == 0) ? clrBuyGreen : clrSellRed;
-      CreateCell("TD_Score_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 value, textColor, clrHighlightBg, false, COL_WIDTH, true);
-   }
+   PanelObjectCreate(name, OBJ_RECTANGLE_LABEL);
+   PanelSetInteger(name, OBJPROP_CORNER, CORNER_LEFT_UPPER);
+   PanelSetInteger(name, OBJPROP_XDISTANCE, x);
+   PanelSetInteger(name, OBJPROP_YDISTANCE, y);
+   PanelSetInteger(name, OBJPROP_XSIZE, width);
+   PanelSetInteger(name, OBJPROP_YSIZE, height);
+   PanelSetInteger(name, OBJPROP_BGCOLOR, bgColor);
+   PanelSetInteger(name, OBJPROP_BORDER_COLOR, borderColor);
+   PanelSetInteger(name, OBJPROP_BORDER_TYPE, BORDER_FLAT);
+   PanelSetInteger(name, OBJPROP_SELECTABLE, false);
+   PanelSetInteger(name, OBJPROP_ZORDER, 0); // ZORDER 0 para fundos
+   PanelSetInteger(name, OBJPROP_HIDDEN, hidden); // Controla a visibilidade
+   RegisterObject(name); // Registra o objeto na seção em construção
+   LOG_DEBUG("[0101] CreateRectLabel: " + name + ", hidden=" + (string)hidden);
 }
 
-//+------------------------------------------------------------------+
-//| Cria a linha de "Pontuação" na tabela. (Função de exemplo)       |
-//+------------------------------------------------------------------+
-void CreatePontuationRow(int x, int y)
+/**
+ * @brief Cria um rótulo de texto no gráfico.
+ * @param name       Nome do objeto (deve ser único).
+ * @param text       O texto a ser exibido.
+ * @param x          Posição X no gráfico.
+ * @param y          Posição Y no gráfico.
+ * @param clr        Cor do texto.
+ * @param fontSize   Tamanho da fonte.
+ * @param font       Nome da fonte.
+ * @param bold       Se o texto deve estar em negrito.
+ * @param hidden     Se o objeto deve ser criado oculto (default: true).
+ */
+void CreateLabel(string name, string text, int x, int y, color clr, int fontSize=8, string font="Arial", bool bold=false, bool hidden=true)
 {
-   CreateCell("TD_Pont_Label", x, y, "Pontuação", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
-   {
-      string value = (i % 3 == 0) ? "7-15-5" : "40-0-5"; // Lógica de exemplo
-      CreateCell("TD_Pont_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 value, clrNormalText, clrHighlightBg, false, COL_WIDTH, true);
-   }
+    PanelObjectCreate(name, OBJ_LABEL); // Cria o objeto de texto (label)
+    PanelSetInteger(name, OBJPROP_CORNER, CORNER_LEFT_UPPER); // Define o canto de referência
+    PanelSetInteger(name, OBJPROP_XDISTANCE, x); // Define a distância X em pixels
+    PanelSetInteger(name, OBJPROP_YDISTANCE, y); // Define a distância Y em pixels
+    PanelSetString(name, OBJPROP_TEXT, text); // Define o texto exibido
+    PanelSetInteger(name, OBJPROP_COLOR, clr); // Define a cor do texto
+    PanelSetInteger(name, OBJPROP_FONTSIZE, bold ? fontSize + 2 : fontSize); // Define o tamanho da fonte (maior se negrito)
+    PanelSetString(name, OBJPROP_FONT, font); // Define o tipo de fonte
+    PanelSetInteger(name, OBJPROP_SELECTABLE, false); // Torna o objeto não selecionável
+    PanelSetInteger(name, OBJPROP_ZORDER, 1); // Define a ordem Z (sobre os fundos)
+    PanelSetInteger(name, OBJPROP_HIDDEN, hidden); // Controla se o objeto está oculto
+    RegisterObject(name); // Registra o objeto na seção em construção
+    LOG_DEBUG("[0100] CreateLabel: " + name + ", hidden=" + (string)hidden); // Log de depuração
 }
 
-//+------------------------------------------------------------------+
-//| Cria a linha de "Pressão DOM" na tabela. (Função de exemplo)     |
-//+------------------------------------------------------------------+
-void CreatePressaoDOMRow(int x, int y)
+/**
+ * @brief Cria uma "célula" da tabela, que é uma combinação de um retângulo de fundo e um texto.
+ * @param name       Prefixo do nome para os objetos da célula.
+ * @param x          Posição X no gráfico.
+ * @param y          Posição Y no gráfico.
+ * @param text       Texto da célula.
+ * @param textColor  Cor do texto.
+ * @param bgColor    Cor de fundo da célula.
+ * @param bold       Se o texto deve estar em negrito.
+ * @param cellWidth  Largura da célula.
+ * @param hidden     Se a célula deve ser criada oculta.
+ * @return Índice da célula no modelo-sombra (cellStates).
+ */
+int CreateCell(string name, int x, int y, string text, color textColor, color bgColor, bool bold=false, int cellWidth = COL_WIDTH, bool hidden=true)
 {
-   CreateCell("TD_Pressao_Label", x, y, "PressaoDOM", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
+   // No modo bitmap, as células da Aba 1 não criam objetos: são pintadas no buffer da tabela
+   bool onCanvas = UseCanvasRenderer && buildSection == TD_SEC_TAB1;
+   
+   if(!onCanvas)
    {
-      int value = 80 + (i * 5); // Lógica de exemplo
-      color textColor = (value > 70) ? clrBuyGreen : clrSellRed;
-      CreateCell("TD_Pressao_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 IntegerToString(value), textColor, clrHighlightBg, false, COL_WIDTH, true);
+      // Cria o fundo da célula
+      CreateRectLabel(name + "_Bg", x, y, cellWidth, ROW_HEIGHT, bgColor, clrGridLines, hidden);
+      // Cria o texto da célula, centralizado verticalmente
+      CreateLabel(name + "_Text", text, x + 5, y + (ROW_HEIGHT / 2) - (FONT_SIZE / 2), textColor, FONT_SIZE, "Arial", bold, hidden);
    }
-}
-
-//+------------------------------------------------------------------+
-//| Cria a linha de "Delta" na tabela. (Função de exemplo)           |
-//+------------------------------------------------------------------+
-void CreateDeltaRow(int x, int y)
-{
-   CreateCell("TD_Delta_Label", x, y, "Delta", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
+   
+   // Registra a célula no modelo-sombra com o valor que acabou de ser enviado ao terminal
+   int idx = cellCount++;
+   ArrayResize(cellStates, cellCount, 256);
+   ArrayResize(dirtyCells, cellCount, 256);
+   cellStates[idx].textObj      = name + "_Text";
+   cellStates[idx].text         = text;
+   cellStates[idx].textColor    = textColor;
+   cellStates[idx].pendingText  = text;
+   cellStates[idx].pendingColor = textColor;
+   cellStates[idx].dirty        = false;
+   cellStates[idx].onCanvas     = onCanvas;
+   cellStates[idx].x            = x;
+   cellStates[idx].y            = y;
+   cellStates[idx].width        = cellWidth;
+   cellStates[idx].bgColor      = bgColor;
+   cellStates[idx].bold         = bold;
+   
+   // Células do bitmap ainda não foram pintadas: força a primeira pintura no próximo frame
+   if(onCanvas)
    {
-      double value = (i % 2 == 0) ? 850.0 + (i * 10) : -720.0 - (i * 10); // Lógica de exemplo
-      color textColor = (value >= 0) ? clrBuyGreen : clrSellRed;
-      CreateCell("TD_Delta_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 DoubleToString(value, 0), textColor, clrHighlightBg, false, COL_WIDTH, true);
+      cellStates[idx].textColor = clrNONE;
+      cellStates[idx].dirty = true;
+      dirtyCells[dirtyCount++] = idx;
    }
+   return idx;
 }
 
-//+------------------------------------------------------------------+
-//| Cria a linha de "Liquidez Maior" na tabela. (Função de exemplo)  |
-//+------------------------------------------------------------------+
-void CreateLiquidityRow(int x, int y)
+/**
+ * @brief Cria um botão de aba, que é uma célula com capacidade de clique.
+ * @param name    Prefixo do nome para os objetos do botão.
+ * @param text    Texto do botão.
+ * @param x       Posição X no gráfico.
+ * @param y       Posição Y no gráfico.
+ * @param width   Largura do botão.
+ * @param height  Altura do botão.
+ * @param active  Se o botão representa a aba ativa.
+ */
+void CreateTabButton(string name, string text, int x, int y, int width, int height, bool active)
 {
-   CreateCell("TD_Liquidez_Label", x, y, "Liquidez Maior", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH, true);
-   for(int i = 0; i < totalSymbols; i++)
-   {
-      double value = 1.0825 + (i * 0.05); // Lógica de exemplo
-      CreateCell("TD_Liquidez_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 DoubleToString(value, 4), clrNormalText, clrHighlightBg, false, COL_WIDTH, true);
-   }
+   color bgColor = active ? clrActiveTab : clrInactiveTab; // Define a cor de fundo com base no estado ativo
+   CreateRectLabel(name + "_Bg", x, y, width, height, bgColor, clrGridLines, false); // Botões de aba nunca são ocultos
+   CreateLabel(name + "_Text", text, x + 10, y + (height / 2) - (HEADER_FONT_SIZE / 2), clrHeaderText, HEADER_FONT_SIZE, "Arial", true, false);
+   PanelSetInteger(name + "_Bg", OBJPROP_SELECTABLE, true); // Torna o fundo do botão clicável
 }
 
 //+------------------------------------------------------------------+
-//| Cria a linha de "Spread" na tabela. (Função de exemplo)          |
+//| Modelo-sombra das Células                                        |
+//| Mantém o último valor enviado ao terminal para cada célula, de   |
+//| forma que apenas as células alteradas gerem chamadas Object*.    |
 //+------------------------------------------------------------------+
-void CreateSpreadRow(int x, int y)
-{
-   CreateCell("TD_Spread_Label", x, y, "Spread", clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH);
-   for(int i = 0; i < totalSymbols; i++)
-   {
-      double value = 1.0 + (i * 0.5); // Lógica de exemplo
-      CreateCell("TD_Spread_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 DoubleToString(value, 1), clrNormalText, clrHighlightBg, false, COL_WIDTH);
-   }
-}
 
-//+------------------------------------------------------------------+
-//| Cria uma linha genérica para uma Média Móvel (MA).               |
-//+------------------------------------------------------------------+
-void CreateMARow(int x, int y, string label)
+/**
+ * @brief Limpa o modelo-sombra e prepara o mapa (linha, coluna) -> célula.
+ */
+void ResetCellModel()
 {
-   CreateCell("TD_MA_" + label + "_Label", x, y, label, clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH);
-   for(int i = 0; i < totalSymbols; i++)
+   cellCount = 0;
+   dirtyCount = 0;
+   headerCornerCell = -1;
+   ArrayFree(cellStates);
+   ArrayFree(dirtyCells);
+   ArrayFree(headerCells);
+   ArrayResize(cellMap, TD_ROW_COUNT * visibleColumns);
+   ArrayInitialize(cellMap, -1);
+}
+
+/**
+ * @brief Preenche a tabela de linhas: rótulo, prefixo dos objetos, visibilidade e formatação.
+ *        Para adicionar uma linha basta um valor em ENUM_TD_ROW e uma entrada aqui.
+ * @param showMask Linhas visíveis, no formato de ShowRowsMask (o benchmark varia a máscara).
+ */
+void ResetRowSchema(int showMask)
+{
+   bool showStatus     = (showMask & (1 << 0)) != 0;
+   bool showAcoes      = (showMask & (1 << 1)) != 0;
+   bool showScore      = (showMask & (1 << 2)) != 0;
+   bool showPontuation = (showMask & (1 << 3)) != 0;
+   bool showPressaoDOM = (showMask & (1 << 4)) != 0;
+   bool showDelta      = (showMask & (1 << 5)) != 0;
+   bool showLiquidity  = (showMask & (1 << 6)) != 0;
+   bool showSpread     = (showMask & (1 << 7)) != 0;
+   bool showMAs        = (showMask & (1 << 8)) != 0;
+   bool showIndicators = (showMask & (1 << 9)) != 0;
+   bool showResults    = (showMask & (1 << 10)) != 0;
+   
+   SetRowSchema(TD_ROW_STATUS,      "Status",           "TD_Status_",         showStatus,      TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_ACOES,       "Ações",            "TD_Acoes_",          showAcoes,       TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_SCORE,       "SCORE",            "TD_Score_",          showScore,       TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_PONT,        "Pontuação",        "TD_Pont_",           showPontuation,  TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_PRESSAO,     "PressaoDOM",       "TD_Pressao_",        showPressaoDOM,  TD_FMT_INTEGER);
+   SetRowSchema(TD_ROW_DELTA,       "Delta",            "TD_Delta_",          showDelta,       TD_FMT_COMPACT);
+   SetRowSchema(TD_ROW_LIQUIDEZ,    "Liquidez Maior",   "TD_Liquidez_",       showLiquidity,   TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_SPREAD,      "Spread (med/p95)", "TD_Spread_",         showSpread,      TD_FMT_TEXT);
+   
+   SetRowSchema(TD_ROW_MA,          "MA",               "TD_MA_MA_",          showMAs,         TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_MA50,        "MA50",             "TD_MA_MA50_",        showMAs,         TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_MA100,       "MA100",            "TD_MA_MA100_",       showMAs,         TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_MA200,       "MA200",            "TD_MA_MA200_",       showMAs,         TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_MA_HTF,      "MA Higher TF",     "TD_MA_HTF_",         showMAs,         TD_FMT_PRICE);
+   
+   SetRowSchema(TD_ROW_ADX,         "ADX",              "TD_Ind_ADX_",        showIndicators,  TD_FMT_INTEGER);
+   SetRowSchema(TD_ROW_ICHIMOKU,    "Ichimoku",         "TD_Ind_Ichimoku_",   showIndicators,  TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_PRICEACTION, "PriceAction",      "TD_Ind_PA_",         showIndicators,  TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_MACD,        "MACD",             "TD_Ind_MACD_",       showIndicators,  TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_RSI,         "RSI",              "TD_Ind_RSI_",        showIndicators,  TD_FMT_INTEGER);
+   SetRowSchema(TD_ROW_CCI,         "CCI",              "TD_Ind_CCI_",        showIndicators,  TD_FMT_INTEGER);
+   SetRowSchema(TD_ROW_T3,          "T3",               "TD_Ind_T3_",         showIndicators,  TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_RIBBON,      "Ribbon",           "TD_Ind_Ribbon_",     showIndicators,  TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_BB,          "BB",               "TD_Ind_BB_",         showIndicators,  TD_FMT_INTEGER);
+   SetRowSchema(TD_ROW_SAR,         "SAR",              "TD_Ind_SAR_",        showIndicators,  TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_ATR,         "ATR",              "TD_Ind_ATR_",        showIndicators,  TD_FMT_PRICE);
+   SetRowSchema(TD_ROW_VOLUME,      "Volume rel.",      "TD_Ind_Volume_",     showIndicators,  TD_FMT_DECIMAL, 2);
+   
+   SetRowSchema(TD_ROW_RR,          "RR",               "TD_Res_RR_",         showResults,     TD_FMT_DECIMAL, 1);
+   SetRowSchema(TD_ROW_AUTO,        "Auto",             "TD_Res_Auto_",       showResults,     TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_WINLOSS,     "Win/Loss",         "TD_Res_WinLoss_",    showResults,     TD_FMT_TEXT);
+   SetRowSchema(TD_ROW_RES_ATIVO,   "Res. ativo",       "TD_Res_Ativo_",      showResults,     TD_FMT_CURRENCY);
+   SetRowSchema(TD_ROW_SALDO,       "Saldo Geral L/P:", "TD_Res_Saldo_",      showResults,     TD_FMT_CURRENCY);
+}
+
+/**
+ * @brief Preenche uma entrada da tabela de linhas.
+ */
+void SetRowSchema(ENUM_TD_ROW row, string label, string prefix, bool visible, ENUM_TD_FORMAT format, int digits = 0)
+{
+   rowSchema[row].label = label;
+   rowSchema[row].prefix = prefix;
+   rowSchema[row].visible = visible;
+   rowSchema[row].format = format;
+   rowSchema[row].digits = digits;
+}
+
+/**
+ * @brief Prepara o armazém de métricas para a lista de símbolos atual. Todas as células
+ *        começam como "..." (aguardando o primeiro cálculo).
+ */
+void ResetMetricStore()
+{
+   int n = TD_ROW_COUNT * totalSymbols;
+   ArrayResize(metricValue, n);
+   ArrayResize(metricText, n);
+   ArrayResize(metricIsText, n);
+   ArrayResize(metricColor, n);
+   ArrayResize(metricVersion, n);
+   ArrayResize(metricShown, n);
+   ArrayInitialize(metricValue, 0.0);
+   ArrayInitialize(metricIsText, true);
+   ArrayInitialize(metricColor, clrNeutralText);
+   ArrayInitialize(metricVersion, 1);
+   ArrayInitialize(metricShown, 0);
+   for(int k = 0; k < n; k++)
+      metricText[k] = "...";
+   firstVisibleSymbol = 0;
+}
+
+/**
+ * @brief Retorna a posição de uma (linha, símbolo) no armazém de métricas e nos sinais.
+ *        As linhas de um mesmo símbolo são contíguas.
+ * @param row         Linha da tabela.
+ * @param symbolIndex Índice do símbolo em symbolArray.
+ */
+int CellSlot(ENUM_TD_ROW row, int symbolIndex)
+{
+   return symbolIndex * TD_ROW_COUNT + (int)row;
+}
+
+/**
+ * @brief Retorna a posição no mapa de células para uma linha e uma coluna visível.
+ * @param row Linha da tabela.
+ * @param col Coluna visível (0 = primeira coluna de símbolos).
+ */
+int ViewSlot(ENUM_TD_ROW row, int col)
+{
+   return (int)row * visibleColumns + col;
+}
+
+/**
+ * @brief Define o texto/cor que uma célula deve exibir no próximo frame.
+ */
+void CellSetPending(int idx, string text, color textColor)
+{
+   if(cellStates[idx].pendingText == text && cellStates[idx].pendingColor == textColor) return;
+   
+   cellStates[idx].pendingText = text;
+   cellStates[idx].pendingColor = textColor;
+   if(!cellStates[idx].dirty)
    {
-      int value = 90 - (i * 5) + (label == "MA" ? 0 : 5); // Lógica de exemplo
-      color textColor = (value > 80) ? clrBuyGreen : clrSellRed;
-      CreateCell("TD_MA_" + label + "_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 IntegerToString(value), textColor, clrHighlightBg, false, COL_WIDTH);
+      cellStates[idx].dirty = true;
+      dirtyCells[dirtyCount++] = idx;
    }
 }
 
-//+------------------------------------------------------------------+
-//| Cria uma linha genérica para um Indicador Técnico.               |
-//+------------------------------------------------------------------+
-void CreateIndicatorRow(int x, int y, string label, bool isSpecialText = false)
+/**
+ * @brief Define o valor desejado de uma célula. Nada é enviado ao terminal aqui;
+ *        a célula apenas entra na lista de pendentes se o valor mudou.
+ * @param row         Linha da tabela.
+ * @param symbolIndex Índice do símbolo em symbolArray.
+ * @param text        Novo texto da célula.
+ * @param textColor   Nova cor do texto.
+ */
+void SetCellValue(ENUM_TD_ROW row, int symbolIndex, string text, color textColor)
 {
-   CreateCell("TD_Ind_" + label + "_Label", x, y, label, clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH);
-   for(int i = 0; i < totalSymbols; i++)
+   int slot = CellSlot(row, symbolIndex);
+   if(metricIsText[slot] && metricText[slot] == text && metricColor[slot] == textColor) return;
+   metricText[slot] = text;
+   metricIsText[slot] = true;
+   metricColor[slot] = textColor;
+   metricVersion[slot]++;
+}
+
+/**
+ * @brief Define o valor numérico de uma (linha, símbolo); o texto é formatado conforme a
+ *        tabela de linhas somente quando o símbolo está visível (SyncVisibleCells).
+ * @param row         Linha da tabela.
+ * @param symbolIndex Índice do símbolo em symbolArray.
+ * @param value       Novo valor.
+ * @param textColor   Nova cor do texto.
+ */
+void SetMetric(ENUM_TD_ROW row, int symbolIndex, double value, color textColor)
+{
+   int slot = CellSlot(row, symbolIndex);
+   if(!metricIsText[slot] && metricValue[slot] == value && metricColor[slot] == textColor) return;
+   metricValue[slot] = value;
+   metricIsText[slot] = false;
+   metricColor[slot] = textColor;
+   metricVersion[slot]++;
+}
+
+/**
+ * @brief Texto exibido para uma (linha, símbolo), conforme o formato da linha.
+ */
+string FormatMetric(ENUM_TD_ROW row, int symbolIndex)
+{
+   int slot = CellSlot(row, symbolIndex);
+   if(metricIsText[slot]) return metricText[slot];
+   
+   double v = metricValue[slot];
+   switch(rowSchema[row].format)
    {
-      string value;
-      color textColor = clrNormalText;
-      if (isSpecialText) // Para indicadores que retornam texto (ex: "Alta", "Baixa", "Lateral")
-      {
-         if (label == "MACD" || label == "T3" || label == "Ribbon")
-         {
-            value = (i % 2 == 0) ? "Lateral" : "Alta";
-            textColor = (value == "Lateral") ? clrNeutralText : (value == "Alta" ? clrBuyGreen : clrSellRed);
-         }
-         else { value = "N/A"; }
-      }
-      else // Para indicadores que retornam um valor numérico
+      case TD_FMT_INTEGER:  return IntegerToString((long)MathRound(v));
+      case TD_FMT_DECIMAL:  return DoubleToString(v, rowSchema[row].digits);
+      case TD_FMT_PRICE:    return DoubleToString(v, sourceDigits[symbolIndex]);
+      case TD_FMT_COMPACT:  return FormatCompact(v);
+      case TD_FMT_CURRENCY: return "R$ " + StringFormat("%.2f", v);
+      default:              return DoubleToString(v, 2);
+   }
+}
+
+/**
+ * @brief Passa para as células das colunas visíveis os valores que mudaram desde a última
+ *        exibição. Uma única varredura (colunas x linhas) por frame; só as versões novas são
+ *        formatadas.
+ * @param force Reenvia todas as células (as colunas passaram a exibir outros símbolos).
+ */
+void SyncVisibleCells(bool force = false)
+{
+   for(int c = 0; c < visibleColumns; c++)
+   {
+      int i = firstVisibleSymbol + c;
+      int base = CellSlot((ENUM_TD_ROW)0, i);
+      for(int row = 0; row < TD_ROW_COUNT; row++)
       {
-         int numericValue = 90 - (i * 3); // Lógica de exemplo
-         value = IntegerToString(numericValue);
-         textColor = (numericValue > 70) ? clrBuyGreen : clrSellRed;
+         int slot = base + row;
+         if(!force && metricShown[slot] == metricVersion[slot]) continue;
+         int idx = cellMap[ViewSlot((ENUM_TD_ROW)row, c)];
+         if(idx < 0) continue; // Linha desabilitada nos parâmetros de entrada
+         CellSetPending(idx, FormatMetric((ENUM_TD_ROW)row, i), metricColor[slot]);
+         metricShown[slot] = metricVersion[slot];
       }
-      CreateCell("TD_Ind_" + label + "_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y, 
-                 value, textColor, clrHighlightBg, false, COL_WIDTH);
    }
 }
 
-//+------------------------------------------------------------------+
-//| Cria uma linha genérica para a seção de Resultados.              |
-//+------------------------------------------------------------------+
-void CreateResultRow(int x, int y, string label, bool isSpecialText = false, bool isCurrency = false)
+/**
+ * @brief Envia ao terminal apenas as propriedades das células que mudaram e
+ *        redesenha o gráfico uma única vez por frame.
+ * @return Número de células efetivamente atualizadas.
+ */
+int FlushPanel()
 {
-   CreateCell("TD_Res_" + label + "_Label", x, y, label, clrHeaderText, clrDarkBg, true, LABEL_COL_WIDTH);
-   for(int i = 0; i < totalSymbols; i++)
+   int pushed = 0;
+   for(int k = 0; k < dirtyCount; k++)
    {
-      string value = "";
-      color textColor = clrNormalText;
-
-      if (isCurrency) // Formata o valor como moeda
+      int idx = dirtyCells[k];
+      cellStates[idx].dirty = false;
+      
+      bool changed = false;
+      if(cellStates[idx].onCanvas)
       {
-         if (label == "Saldo Geral L/P:") // Caso especial para o saldo geral, que ocupa uma célula
+         // Célula do bitmap: repinta apenas o retângulo da célula no buffer
+         if(cellStates[idx].text != cellStates[idx].pendingText || cellStates[idx].textColor != cellStates[idx].pendingColor)
          {
-            if (i == 0) {
-               double amount = 250.00;
-               value = "R$ " + StringFormat("%.2f", amount);
-               textColor = clrBuyGreen;
-            } else {
-               value = " "; // Deixa as outras células da linha em branco
-            }
-         } else {
-            double amount = (i % 2 == 0) ? -50.00 : 100.00;
-            value = "R$ " + StringFormat("%.2f", amount);
-            textColor = (amount >= 0) ? clrBuyGreen : clrSellRed;
+            cellStates[idx].text = cellStates[idx].pendingText;
+            cellStates[idx].textColor = cellStates[idx].pendingColor;
+            CanvasPaintCell(idx);
+            pushed++;
          }
+         continue;
       }
-      else if (isSpecialText) // Formata como texto especial (X ou placar)
+      if(cellStates[idx].text != cellStates[idx].pendingText)
       {
-         if (label == "Auto") value = "X";
-         else if (label == "Win/Loss") value = StringFormat("%d/%d", (i * 2 + 3), (i * 3 + 7));
+         PanelSetString(cellStates[idx].textObj, OBJPROP_TEXT, cellStates[idx].pendingText);
+         cellStates[idx].text = cellStates[idx].pendingText;
+         changed = true;
       }
-      else // Formata como número decimal
+      if(cellStates[idx].textColor != cellStates[idx].pendingColor)
       {
-         double numValue = 1.2 + (i * 0.3);
-         value = DoubleToString(numValue, 1);
+         PanelSetInteger(cellStates[idx].textObj, OBJPROP_COLOR, cellStates[idx].pendingColor);
+         cellStates[idx].textColor = cellStates[idx].pendingColor;
+         changed = true;
       }
-      CreateCell("TD_Res_" + label + "_" + IntegerToString(i), x + LABEL_COL_WIDTH + (i * COL_WIDTH), y,
-                 value, textColor, clrHighlightBg, false, COL_WIDTH);
+      if(changed) pushed++;
    }
+   dirtyCount = 0;
+   
+   // Envia o buffer do bitmap ao terminal uma única vez, se alguma célula foi repintada
+   if(canvasDirty)
+      CanvasUpload();
+   
+   // Um único redesenho por frame, e somente se algo mudou
+   if(pushed > 0) PanelRedraw();
+   return pushed;
 }
 
 //+------------------------------------------------------------------+
-//| Cria o conteúdo da segunda aba. (Atualmente, um placeholder)     |
+//| Renderizador em Bitmap da Aba 1                                  |
+//| Desenha toda a tabela em um único OBJ_BITMAP_LABEL. Os glifos    |
+//| são renderizados uma vez e reaproveitados; a cada frame apenas   |
+//| os retângulos das células alteradas são repintados.              |
 //+------------------------------------------------------------------+
-void CreateTab2()
-{
-   int x = MARGIN;
-   int y = MARGIN + HEADER_HEIGHT;
 
-   // Cria o fundo da aba 2 (inicialmente oculto)
-   CreateRectLabel("TD_Tab2_Bg", x, y, panelWidth - (2*MARGIN), panelHeight - HEADER_HEIGHT - MARGIN - 5, clrDarkBg, clrGridLines, true);
+/**
+ * @brief Cria o objeto bitmap e o buffer de pixels com o tamanho da área da tabela.
+ */
+void CanvasCreate()
+{
+   canvasWidth = layoutGrid.w;
+   canvasHeight = layoutGrid.h;
+   ArrayResize(canvasPixels, canvasWidth * canvasHeight);
+   ArrayInitialize(canvasPixels, ColorToARGB(clrDarkBg));
+   GlyphCacheClear();
+   
+   PanelObjectCreate(CANVAS_OBJECT, OBJ_BITMAP_LABEL);
+   PanelSetInteger(CANVAS_OBJECT, OBJPROP_CORNER, CORNER_LEFT_UPPER);
+   PanelSetInteger(CANVAS_OBJECT, OBJPROP_XDISTANCE, layoutGrid.x);
+   PanelSetInteger(CANVAS_OBJECT, OBJPROP_YDISTANCE, layoutGrid.y);
+   PanelSetString(CANVAS_OBJECT, OBJPROP_BMPFILE, CANVAS_RESOURCE);
+   PanelSetInteger(CANVAS_OBJECT, OBJPROP_SELECTABLE, false);
+   PanelSetInteger(CANVAS_OBJECT, OBJPROP_ZORDER, 1);
+   PanelSetInteger(CANVAS_OBJECT, OBJPROP_HIDDEN, true);
+   RegisterObject(CANVAS_OBJECT);
+   
+   canvasDirty = true;
+}
 
-   Print("[0010] CreateTab2 chamada. Criando elementos da aba 2 como ocultos");
+/**
+ * @brief Envia o buffer de pixels ao terminal (recria o recurso do bitmap).
+ */
+void CanvasUpload()
+{
+   apiCalls[TD_API_RESOURCE]++;
+   ResourceCreate(CANVAS_RESOURCE, canvasPixels, canvasWidth, canvasHeight, 0, 0, 0, COLOR_FORMAT_XRGB_NOALPHA);
+   canvasDirty = false;
+}
 
-   // Cria os textos da aba 2 (inicialmente ocultos)
-   CreateLabel("TD_Tab2_Content", "Conteúdo da Guia 2", x + 10, y + 10, clrNormalText, FONT_SIZE, "Arial", false, true);
-   CreateLabel("TD_Tab2_Content2", "Aqui você pode adicionar informações sobre saldo da conta, histórico de trades, etc.", x + 10, y + 30, clrNormalText, FONT_SIZE, "Arial", false, true);
+/**
+ * @brief Libera o recurso do bitmap e o cache de glifos.
+ */
+void CanvasDestroy()
+{
+   ResourceFree(CANVAS_RESOURCE);
+   ArrayFree(canvasPixels);
+   canvasWidth = 0;
+   canvasHeight = 0;
+   canvasDirty = false;
+   GlyphCacheClear();
 }
 
+/**
+ * @brief Esvazia o cache de glifos.
+ */
+void GlyphCacheClear()
+{
+   glyphIndex.Clear();
+   ArrayFree(glyphPixels);
+   ArrayFree(glyphOffset);
+   ArrayFree(glyphWidth);
+   ArrayFree(glyphHeight);
+   glyphCount = 0;
+   glyphPixelCount = 0;
+}
 
-//+------------------------------------------------------------------+
-//| Funções Auxiliares para Criação de Objetos Gráficos              |
-//+------------------------------------------------------------------+
+/**
+ * @brief Retorna o glifo de um caractere já renderizado sobre a cor de fundo,
+ *        renderizando-o e guardando-o no cache na primeira vez.
+ * @param ch      Caractere (pode ter mais de uma unidade UTF-16, como emojis).
+ * @param fg      Cor do texto.
+ * @param bg      Cor de fundo da célula.
+ * @param bold    Se o texto é em negrito.
+ * @return Índice do glifo nos arrays do cache.
+ */
+int GlyphGet(string ch, color fg, color bg, bool bold)
+{
+   string key = ch + "|" + IntegerToString(fg) + "|" + IntegerToString(bg) + (bold ? "|b" : "");
+   int g;
+   if(glyphIndex.TryGetValue(key, g)) return g;
+   
+   if(glyphCount >= GLYPH_CACHE_MAX) GlyphCacheClear();
+   
+   // Mesma fonte usada por CreateLabel (negrito = 2 pontos maior)
+   TextSetFont("Arial", -(bold ? FONT_SIZE + 2 : FONT_SIZE) * 10, bold ? FW_BOLD : FW_NORMAL);
+   uint w = 0, h = 0;
+   TextGetSize(ch, w, h);
+   if(w == 0 || h == 0) { w = 1; h = 1; }
+   
+   uint pixels[];
+   ArrayResize(pixels, (int)(w * h));
+   ArrayInitialize(pixels, ColorToARGB(bg));
+   TextOut(ch, 0, 0, TA_LEFT | TA_TOP, pixels, w, h, ColorToARGB(fg), COLOR_FORMAT_XRGB_NOALPHA);
+   
+   g = glyphCount++;
+   ArrayResize(glyphOffset, glyphCount, 64);
+   ArrayResize(glyphWidth, glyphCount, 64);
+   ArrayResize(glyphHeight, glyphCount, 64);
+   glyphOffset[g] = glyphPixelCount;
+   glyphWidth[g] = (int)w;
+   glyphHeight[g] = (int)h;
+   
+   glyphPixelCount += (int)(w * h);
+   ArrayResize(glyphPixels, glyphPixelCount, 16384);
+   ArrayCopy(glyphPixels, pixels, glyphOffset[g], 0, (int)(w * h));
+   
+   glyphIndex.Add(key, g);
+   return g;
+}
 
 /**
- * @brief Cria um rótulo retangular no gráfico.
- * @param name          Nome do objeto (deve ser único).
- * @param x             Posição X no gráfico.
- * @param y             Posição Y no gráfico.
- * @param width         Largura do retângulo.
- * @param height        Altura do retângulo.
- * @param bgColor       Cor de fundo.
- * @param borderColor   Cor da borda.
- * @param hidden        Se o objeto deve ser criado oculto (default: true).
+ * @brief Repinta no buffer o retângulo de uma célula (fundo, borda e texto).
+ * @param idx Índice da célula em cellStates.
  */
-void CreateRectLabel(string name, int x, int y, int width, int height, color bgColor, color borderColor, bool hidden=true)
+void CanvasPaintCell(int idx)
 {
-   ObjectCreate(0, name, OBJ_RECTANGLE_LABEL, 0, 0, 0);
-   ObjectSetInteger(0, name, OBJPROP_CORNER, CORNER_LEFT_UPPER);
-   ObjectSetInteger(0, name, OBJPROP_XDISTANCE, x);
-   ObjectSetInteger(0, name, OBJPROP_YDISTANCE, y);
-   ObjectSetInteger(0, name, OBJPROP_XSIZE, width);
-   ObjectSetInteger(0, name, OBJPROP_YSIZE, height);
-   ObjectSetInteger(0, name, OBJPROP_BGCOLOR, bgColor);
-   ObjectSetInteger(0, name, OBJPROP_BORDER_COLOR, borderColor);
-   ObjectSetInteger(0, name, OBJPROP_BORDER_TYPE, BORDER_FLAT);
-   ObjectSetInteger(0, name, OBJPROP_SELECTABLE, false);
-   ObjectSetInteger(0, name, OBJPROP_ZORDER, 0); // ZORDER 0 para fundos
-   ObjectSetInteger(0, name, OBJPROP_HIDDEN, hidden); // Controla a visibilidade
-   Print("[0101] DEBUG CreateRectLabel: ", name, ", hidden=", hidden);
+   int x0 = cellStates[idx].x - layoutGrid.x;
+   int y0 = cellStates[idx].y - layoutGrid.y;
+   int w = MathMin(cellStates[idx].width, canvasWidth - x0);
+   int h = MathMin(ROW_HEIGHT, canvasHeight - y0);
+   if(x0 < 0 || y0 < 0 || w <= 0 || h <= 0) return;
+   
+   // Fundo e borda (equivalentes ao CreateRectLabel da célula)
+   uint bg = ColorToARGB(cellStates[idx].bgColor);
+   uint border = ColorToARGB(clrGridLines);
+   for(int r = 0; r < h; r++)
+   {
+      int rowStart = (y0 + r) * canvasWidth + x0;
+      if(r == 0 || r == h - 1)
+         ArrayFill(canvasPixels, rowStart, w, border);
+      else
+      {
+         ArrayFill(canvasPixels, rowStart, w, bg);
+         canvasPixels[rowStart] = border;
+         canvasPixels[rowStart + w - 1] = border;
+      }
+   }
+   
+   // Texto, composto glifo a glifo, na mesma posição usada por CreateCell
+   string text = cellStates[idx].text;
+   int len = StringLen(text);
+   int penX = x0 + 5;
+   int penY = y0 + (ROW_HEIGHT / 2) - (FONT_SIZE / 2);
+   int clipX = x0 + w - 1;
+   int pos = 0;
+   while(pos < len && penX < clipX)
+   {
+      // Agrupa pares substitutos (emojis) e o seletor de variação U+FE0F em um único glifo
+      int n = 1;
+      ushort c = StringGetCharacter(text, pos);
+      if(c >= 0xD800 && c <= 0xDBFF && pos + 1 < len) n = 2;
+      if(pos + n < len && StringGetCharacter(text, pos + n) == 0xFE0F) n++;
+      string ch = StringSubstr(text, pos, n);
+      pos += n;
+      
+      int g = GlyphGet(ch, cellStates[idx].textColor, cellStates[idx].bgColor, cellStates[idx].bold);
+      int gw = MathMin(glyphWidth[g], clipX - penX);
+      int gh = MathMin(glyphHeight[g], y0 + h - 1 - penY);
+      for(int r = 0; r < gh; r++)
+         ArrayCopy(canvasPixels, glyphPixels, (penY + r) * canvasWidth + penX, glyphOffset[g] + r * glyphWidth[g], gw);
+      penX += glyphWidth[g];
+   }
+   canvasDirty = true;
 }
 
+//+------------------------------------------------------------------+
+//| Registro de Objetos por Seção                                    |
+//| Permite mostrar/ocultar uma aba percorrendo apenas os objetos    |
+//| que ela possui, sem varrer todos os objetos do gráfico.          |
+//+------------------------------------------------------------------+
+
 /**
- * @brief Cria um rótulo de texto no gráfico.
- * @param name       Nome do objeto (deve ser único).
- * @param text       O texto a ser exibido.
- * @param x          Posição X no gráfico.
- * @param y          Posição Y no gráfico.
- * @param clr        Cor do texto.
- * @param fontSize   Tamanho da fonte.
- * @param font       Nome da fonte.
- * @param bold       Se o texto deve estar em negrito.
- * @param hidden     Se o objeto deve ser criado oculto (default: true).
+ * @brief Esvazia o registro de objetos de todas as seções.
  */
-void CreateLabel(string name, string text, int x, int y, color clr, int fontSize=8, string font="Arial", bool bold=false, bool hidden=true)
+void ResetObjectRegistry()
 {
-    ObjectCreate(0, name, OBJ_LABEL, 0, 0, 0); // Cria o objeto de texto (label)
-    ObjectSetInteger(0, name, OBJPROP_CORNER, CORNER_LEFT_UPPER); // Define o canto de referência
-    ObjectSetInteger(0, name, OBJPROP_XDISTANCE, x); // Define a distância X em pixels
-    ObjectSetInteger(0, name, OBJPROP_YDISTANCE, y); // Define a distância Y em pixels
-    ObjectSetString(0, name, OBJPROP_TEXT, text); // Define o texto exibido
-    ObjectSetInteger(0, name, OBJPROP_COLOR, clr); // Define a cor do texto
-    ObjectSetInteger(0, name, OBJPROP_FONTSIZE, bold ? fontSize + 2 : fontSize); // Define o tamanho da fonte (maior se negrito)
-    ObjectSetString(0, name, OBJPROP_FONT, font); // Define o tipo de fonte
-    ObjectSetInteger(0, name, OBJPROP_SELECTABLE, false); // Torna o objeto não selecionável
-    ObjectSetInteger(0, name, OBJPROP_ZORDER, 1); // Define a ordem Z (sobre os fundos)
-    ObjectSetInteger(0, name, OBJPROP_HIDDEN, hidden); // Controla se o objeto está oculto
-    Print("[0100] DEBUG CreateLabel: ", name, ", hidden=", hidden); // Log de depuração
+   for(int sec = 0; sec < TD_SEC_COUNT; sec++)
+   {
+      ArrayFree(sectionObjects[sec].names);
+      sectionObjects[sec].count = 0;
+      sectionVisible[sec] = -1;
+   }
+   buildSection = TD_SEC_HEADER;
 }
 
 /**
- * @brief Cria uma "célula" da tabela, que é uma combinação de um retângulo de fundo e um texto.
- * @param name       Prefixo do nome para os objetos da célula.
- * @param x          Posição X no gráfico.
- * @param y          Posição Y no gráfico.
- * @param text       Texto da célula.
- * @param textColor  Cor do texto.
- * @param bgColor    Cor de fundo da célula.
- * @param bold       Se o texto deve estar em negrito.
- * @param cellWidth  Largura da célula.
- * @param hidden     Se a célula deve ser criada oculta.
+ * @brief Adiciona um objeto à seção que está sendo construída (buildSection).
+ * @param name Nome do objeto criado.
  */
-void CreateCell(string name, int x, int y, string text, color textColor, color bgColor, bool bold=false, int cellWidth = COL_WIDTH, bool hidden=true)
+void RegisterObject(string name)
 {
-   // Cria o fundo da célula
-   CreateRectLabel(name + "_Bg", x, y, cellWidth, ROW_HEIGHT, bgColor, clrGridLines, hidden);
-   // Cria o texto da célula, centralizado verticalmente
-   CreateLabel(name + "_Text", text, x + 5, y + (ROW_HEIGHT / 2) - (FONT_SIZE / 2), textColor, FONT_SIZE, "Arial", bold, hidden);
+   int n = sectionObjects[buildSection].count++;
+   ArrayResize(sectionObjects[buildSection].names, n + 1, 512);
+   sectionObjects[buildSection].names[n] = name;
 }
 
 /**
- * @brief Cria um botão de aba, que é uma célula com capacidade de clique.
- * @param name    Prefixo do nome para os objetos do botão.
- * @param text    Texto do botão.
- * @param x       Posição X no gráfico.
- * @param y       Posição Y no gráfico.
- * @param width   Largura do botão.
- * @param height  Altura do botão.
- * @param active  Se o botão representa a aba ativa.
+ * @brief Mostra ou oculta todos os objetos de uma seção.
+ *        Não faz nada se a seção já estiver no estado pedido.
+ * @param sec     Seção a ser alterada.
+ * @param visible true para exibir, false para ocultar.
  */
-void CreateTabButton(string name, string text, int x, int y, int width, int height, bool active)
+void SetSectionVisible(ENUM_TD_SECTION sec, bool visible)
 {
-   color bgColor = active ? clrActiveTab : clrInactiveTab; // Define a cor de fundo com base no estado ativo
-   CreateRectLabel(name + "_Bg", x, y, width, height, bgColor, clrGridLines, false); // Botões de aba nunca são ocultos
-   CreateLabel(name + "_Text", text, x + 10, y + (height / 2) - (HEADER_FONT_SIZE / 2), clrHeaderText, HEADER_FONT_SIZE, "Arial", true, false);
-   ObjectSetInteger(0, name + "_Bg", OBJPROP_SELECTABLE, true); // Torna o fundo do botão clicável
+   int state = visible ? 1 : 0;
+   if(sectionVisible[sec] == state) return;
+   
+   for(int i = 0; i < sectionObjects[sec].count; i++)
+      PanelSetInteger(sectionObjects[sec].names[i], OBJPROP_HIDDEN, !visible);
+   sectionVisible[sec] = state;
 }
 
 //+------------------------------------------------------------------+
@@ -598,56 +1731,69 @@ void CreateTabButton(string name, string text, int x, int y, int width, int heig
  */
 void SwitchTab(int tab)
 {
-    Print("DEBUG, tab=", tab);
-   Print("[0200] SwitchTab acionado. Tab = ", tab, ", Minimized = ", panelMinimized);
+   LOG_DEBUG("[0200] SwitchTab acionado. Tab = " + IntegerToString(tab) + ", Minimized = " + (string)panelMinimized);
    
    // 1. Atualiza a cor de fundo dos botões das abas para refletir a seleção
-   ObjectSetInteger(0, "TD_Tab1_Bg", OBJPROP_BGCOLOR, (tab == 1) ? clrActiveTab : clrInactiveTab);
-    Print("[0210] TD_Tab1_Bg -> ", (tab == 1) ? "ATIVA" : "INATIVA");
-   ObjectSetInteger(0, "TD_Tab2_Bg", OBJPROP_BGCOLOR, (tab == 2) ? clrActiveTab : clrInactiveTab);
+   PanelSetInteger("TD_Tab1_Bg", OBJPROP_BGCOLOR, (tab == 1) ? clrActiveTab : clrInactiveTab);
+   PanelSetInteger("TD_Tab2_Bg", OBJPROP_BGCOLOR, (tab == 2) ? clrActiveTab : clrInactiveTab);
 
    // 2. Determina a visibilidade de cada aba com base na aba selecionada e no estado minimizado
    bool showTab1 = (tab == 1) && !panelMinimized;
    bool showTab2 = (tab == 2) && !panelMinimized;
 
-   // 3. Itera por todos os objetos do gráfico para mostrar/ocultar os elementos da Aba 1
-   for(int i = 0; i < ObjectsTotal(0); i++)
-   {
-      string name = ObjectName(0, i);
-   
-      // Verifica se o nome do objeto pertence à Aba 1 (tabela de dados)
-      bool isTab1 =
-         StringFind(name, "TD_Header_", 0) == 0 ||
-         StringFind(name, "TD_Status_", 0) == 0 ||
-         StringFind(name, "TD_Acoes_", 0) == 0 ||
-         StringFind(name, "TD_Score_", 0) == 0 ||
-         StringFind(name, "TD_Pont_", 0) == 0 ||
-         StringFind(name, "TD_Pressao_", 0) == 0 ||
-         StringFind(name, "TD_Delta_", 0) == 0 ||
-         StringFind(name, "TD_Liquidez_", 0) == 0 ||
-         StringFind(name, "TD_Spread_", 0) == 0 ||
-         StringFind(name, "TD_MA_", 0) == 0 ||
-         StringFind(name, "TD_Ind_", 0) == 0 ||
-         StringFind(name, "TD_Res_", 0) == 0;
-   
-      // Define a propriedade HIDDEN do objeto. Se showTab1 for true, HIDDEN é false (mostra o objeto).
-      if(isTab1)
-         ObjectSetInteger(0, name, OBJPROP_HIDDEN, !showTab1);
-         
-      Print("010 - DEBUG [SwitchTab] ", name, " => ", !showTab1 ? "OCULTO" : "VISÍVEL");
-   }
-
-   // 4. Controla a visibilidade dos elementos da Aba 2 diretamente
-   ObjectSetInteger(0, "TD_Tab2_Bg", OBJPROP_HIDDEN, !showTab2);
-   ObjectSetInteger(0, "TD_Tab2_Content", OBJPROP_HIDDEN, !showTab2);
-   ObjectSetInteger(0, "TD_Tab2_Content2", OBJPROP_HIDDEN, !showTab2);
-
-   Print("[0220] TD_Tab2_Bg -> ", showTab2 ? "VISÍVEL" : "OCULTO");
-   Print("[0221] TD_Tab2_Content -> ", showTab2 ? "VISÍVEL" : "OCULTO");
-   Print("[0222] TD_Tab2_Content2 -> ", showTab2 ? "VISÍVEL" : "OCULTO");
-
-   // 5. Atualiza a variável global da aba ativa
+   // 3. Mostra/oculta os objetos registrados de cada aba (apenas os objetos deste painel)
+   SetSectionVisible(TD_SEC_TAB1, showTab1);
+   SetSectionVisible(TD_SEC_TAB2, showTab2);
+
+   LOG_DEBUG("[0220] Aba 1 -> " + (showTab1 ? "VISÍVEL" : "OCULTO") + ", Aba 2 -> " + (showTab2 ? "VISÍVEL" : "OCULTO"));
+
+   // 4. Atualiza a variável global da aba ativa
    activeTab = tab;
+   
+   // 5. A aba de latências é atualizada só quando visível: ao abri-la, mostra os valores atuais
+   if(showTab2) UpdateLatencyTab(true);
+}
+
+/**
+ * @brief Texto do canto da tabela: faixa de símbolos exibida, com setas quando a tabela rola.
+ */
+string ScrollRangeText()
+{
+   if(totalSymbols <= visibleColumns) return " ";
+   return "◄ " + IntegerToString(firstVisibleSymbol + 1) + "-" + IntegerToString(firstVisibleSymbol + visibleColumns) +
+          "/" + IntegerToString(totalSymbols) + " ►";
+}
+
+/**
+ * @brief Rola as colunas da tabela. As células das colunas passam a exibir os valores
+ *        guardados dos novos símbolos; nenhum objeto é criado ou apagado.
+ * @param delta Número de colunas (negativo = símbolos anteriores).
+ */
+void ScrollColumns(int delta)
+{
+   int first = MathMax(0, MathMin(firstVisibleSymbol + delta, totalSymbols - visibleColumns));
+   if(first == firstVisibleSymbol) return;
+   firstVisibleSymbol = first;
+   LOG_DEBUG("[0310] Tabela rolada. Primeiro símbolo: " + IntegerToString(firstVisibleSymbol));
+   
+   for(int c = 0; c < visibleColumns; c++)
+      CellSetPending(headerCells[c], symbolArray[firstVisibleSymbol + c], clrHeaderText);
+   CellSetPending(headerCornerCell, ScrollRangeText(), clrHeaderText);
+   SyncVisibleCells(true);
+   FlushPanel();
+}
+
+/**
+ * @brief Recria o painel se a largura do gráfico passou a comportar outro número de colunas.
+ */
+void ResizePanel()
+{
+   if(FitColumns() == visibleColumns) return;
+   ObjectsDeleteAll(0, "TD_");
+   CanvasDestroy();
+   CalculatePanelSize();
+   CreatePanel();
+   LOG_DEBUG("[0311] Painel recriado com " + IntegerToString(visibleColumns) + " colunas visíveis");
 }
 
 //+------------------------------------------------------------------+
@@ -657,16 +1803,16 @@ void ToggleMinimize()
 {
    panelMinimized = !panelMinimized; // Inverte o estado booleano
    
-   Print("[0300] ToggleMinimize acionado. Novo estado: ", panelMinimized);
+   LOG_DEBUG("[0300] ToggleMinimize acionado. Novo estado: " + (string)panelMinimized);
 
    // Ajusta a altura do fundo principal para corresponder ao estado minimizado/maximizado
-   ObjectSetInteger(0, "TD_MainBg", OBJPROP_YSIZE, panelMinimized ? HEADER_HEIGHT + MARGIN : panelHeight - (2*MARGIN));
+   PanelSetInteger("TD_MainBg", OBJPROP_YSIZE, panelMinimized ? HEADER_HEIGHT + MARGIN : panelHeight - (2*MARGIN));
    
    // Chama SwitchTab para ocultar/mostrar o conteúdo das abas conforme necessário
    SwitchTab(activeTab);
    
    // Atualiza o ícone do botão para refletir o novo estado
-   ObjectSetString(0, "TD_MinimizeBtn", OBJPROP_TEXT, panelMinimized ? "[▲]" : "[▼]");
+   PanelSetString("TD_MinimizeBtn", OBJPROP_TEXT, panelMinimized ? "[▲]" : "[▼]");
 }
 
 //+------------------------------------------------------------------+
@@ -675,19 +1821,39 @@ void ToggleMinimize()
 //+------------------------------------------------------------------+
 void OnChartEvent(const int id, const long &lparam, const double &dparam, const string &sparam)
 {
+   // No modo bitmap, os cliques são resolvidos pelo layout do painel (ver CalculatePanelSize)
+   if(id == CHARTEVENT_CHART_CHANGE)
+   {
+      ResizePanel();
+      return;
+   }
+   if(UseCanvasRenderer)
+   {
+      if(id == CHARTEVENT_CLICK)
+         HandlePanelClick((int)lparam, (int)dparam);
+      return;
+   }
+   
+   // As setas de rolagem ficam na célula do canto da tabela: são resolvidas pela posição do clique
+   if(id == CHARTEVENT_CLICK)
+   {
+      HandleScrollClick((int)lparam, (int)dparam);
+      return;
+   }
+   
    // Verifica se o evento é um clique em um objeto
    if(id == CHARTEVENT_OBJECT_CLICK)
    {
       // Se o clique foi em um objeto da Aba 1
       if(StringFind(sparam, "TD_Tab1") >= 0)
       {
-         Print("Clicou na Guia 1");
+         LOG_DEBUG("[0400] Clicou na Guia 1");
          SwitchTab(1);
       }
       // Se o clique foi em um objeto da Aba 2
       else if(StringFind(sparam, "TD_Tab2") >= 0)
       {
-         Print("Clicou na Guia 2");
+         LOG_DEBUG("[0401] Clicou na Guia 2");
          SwitchTab(2);
       }
       // Se o clique foi no botão de minimizar
@@ -698,110 +1864,261 @@ void OnChartEvent(const int id, const long &lparam, const double &dparam, const
    }
 }
 
+/**
+ * @brief Trata um clique no gráfico usando o layout calculado em CalculatePanelSize.
+ * @param px Coordenada X do clique em pixels.
+ * @param py Coordenada Y do clique em pixels.
+ */
+void HandlePanelClick(int px, int py)
+{
+   if(PointInRect(layoutTab1Btn, px, py))
+      SwitchTab(1);
+   else if(PointInRect(layoutTab2Btn, px, py))
+      SwitchTab(2);
+   else if(PointInRect(layoutMinimizeBtn, px, py))
+      ToggleMinimize();
+   else
+      HandleScrollClick(px, py);
+}
+
+/**
+ * @brief Rola a tabela uma página quando o clique cai em uma das metades do canto da tabela.
+ * @param px Coordenada X do clique em pixels.
+ * @param py Coordenada Y do clique em pixels.
+ */
+void HandleScrollClick(int px, int py)
+{
+   if(activeTab != 1 || panelMinimized || totalSymbols <= visibleColumns) return;
+   if(PointInRect(layoutScrollLeft, px, py))
+      ScrollColumns(-visibleColumns);
+   else if(PointInRect(layoutScrollRight, px, py))
+      ScrollColumns(visibleColumns);
+}
+
 //+------------------------------------------------------------------+
 //| Função de Tick do Expert                                         |
 //| É executada a cada nova cotação (tick) do mercado.               |
 //+------------------------------------------------------------------+
 void OnTick()
 {
-   // Chama a função para atualizar os valores dinâmicos do painel
+   // O trabalho é feito no timer; aqui o tick do símbolo do gráfico apenas marca um recálculo pendente
+   if(chartSymbolIndex >= 0)
+   {
+      if(symbolPending[chartSymbolIndex]) ticksCoalesced++;
+      symbolPending[chartSymbolIndex] = true;
+   }
+}
+
+//+------------------------------------------------------------------+
+//| Função de Timer do Expert                                        |
+//| Cada disparo do timer é um frame de atualização do painel.       |
+//+------------------------------------------------------------------+
+void OnTimer()
+{
    UpdatePanelValues();
+   UpdateLatencyTab();
+   ExportFrame();
+   BarCacheReport();
+   ScoreReport();
+   
+   // Grava no arquivo, de uma vez, os ticks codificados neste frame
+   RecordFlush();
+   
+   // Envia ao diário, de uma vez, as mensagens acumuladas neste ciclo
+   LogFlush();
 }
 
 //+------------------------------------------------------------------+
-//| Atualiza os valores exibidos no painel.                          |
-//| Esta função deve conter a lógica de cálculo dos indicadores.     |
+//| Atualiza os valores exibidos no painel (um frame).               |
+//| Detecta ticks novos de cada símbolo, recalcula cada símbolo com  |
+//| tick novo no máximo uma vez e respeita o orçamento do frame.     |
 //+------------------------------------------------------------------+
 void UpdatePanelValues()
 {
-   // Se o painel estiver minimizado, não há necessidade de atualizar os valores
+   ulong frameStart = GetMicrosecondCount();
+   frameNumber++;
+   
+   // 1. Detecta ticks novos comparando o time_msc do último tick de cada símbolo.
+   //    Vários ticks entre dois frames resultam em um único recálculo.
+   //    Na reprodução e no gerador, os ticks do frame vão para as filas dos símbolos.
+   if(tickSource != TICK_SOURCE_LIVE)
+      TickSourceAdvance();
+   
+   MqlTick tick;
+   for(int i = 0; i < totalSymbols && tickSource == TICK_SOURCE_LIVE; i++)
+   {
+      if(!SymbolInfoTick(symbolArray[i], tick)) continue;
+      if(tick.time_msc == lastTickMsc[i]) continue;
+      lastTickMsc[i] = tick.time_msc;
+      if(symbolPending[i]) ticksCoalesced++;
+      symbolPending[i] = true;
+   }
+   
+   // Se o painel estiver minimizado, os símbolos ficam pendentes até ele ser restaurado
    if (panelMinimized) return;
-
-   // Itera sobre cada símbolo monitorado
+   
+   // Cria alguns handles de indicador por frame; o terminal os calcula em segundo plano
+   IndicatorPoolService();
+   
+   // 2. Recalcula os símbolos pendentes em rodízio, começando de onde o frame anterior parou,
+   //    para que um símbolo muito ativo não impeça a atualização das outras colunas.
+   ulong budget = (benchBudgetUs > 0) ? benchBudgetUs : (ulong)MathMax(FrameBudgetMs, 1) * 1000;
+   int next = schedCursor;
+   for(int n = 0; n < totalSymbols; n++)
+   {
+      int i = (schedCursor + n) % totalSymbols;
+      if(!symbolPending[i]) continue;
+      if(GetMicrosecondCount() - frameStart > budget)
+      {
+         symbolsDeferred++;
+         continue; // Continua apenas para contar os adiados; o cálculo fica para o próximo frame
+      }
+      // Limpa antes de calcular: o cálculo pode marcar o símbolo de novo se ficou trabalho para o próximo frame
+      symbolPending[i] = false;
+      UpdateSymbolValues(i);
+      symbolsRecomputed++;
+      next = (i + 1) % totalSymbols;
+   }
+   schedCursor = next;
+   
+   // Tempo até o primeiro frame em que todos os símbolos estão em dia
+   if(!firstFullFrameLogged && !AnySymbolPending())
+   {
+      firstFullFrameLogged = true;
+      LOG_INFO("[1700] Primeiro frame completo em " + IntegerToString((long)((GetMicrosecondCount() - initStartUs) / 1000)) +
+               " ms (" + (snapshotLoaded ? "estado restaurado" : "sem estado salvo") + ")");
+   }
+   
+   // 3. Pressão do DOM: os eventos do livro apenas atualizam o estado; a célula é
+   //    atualizada aqui, no máximo uma vez por frame, para os livros que mudaram
    for(int i = 0; i < totalSymbols; i++)
+      if(bookStates[i].changed)
+         UpdatePressaoDOMRow(i);
+   
+   // 4. Score, Pontuação, Status e Ações: só para os símbolos cujas entradas mudaram neste frame
+   UpdateScores();
+   UpdateResultsTotal();
+   
+   // 5. Passa às células visíveis os valores novos do armazém de métricas e envia ao
+   //    terminal somente as células alteradas, com um único ChartRedraw
+   PROBE_BEGIN(diffStart);
+   SyncVisibleCells();
+   PROBE_END(TD_STAGE_DIFF, diffStart);
+   PROBE_BEGIN(renderStart);
+   FlushPanel();
+   PROBE_END(TD_STAGE_RENDER, renderStart);
+   PROBE_END(TD_STAGE_FRAME, frameStart);
+}
+
+/**
+ * @brief Recalcula e registra no modelo-sombra todas as métricas de um símbolo.
+ * @param i Índice do símbolo em symbolArray.
+ */
+void UpdateSymbolValues(int i)
+{
+   string symbol = symbolArray[i];
+   
+   // Lê somente os ticks novos do símbolo e alimenta os motores baseados em ticks (Delta e Liquidez)
+   PROBE_BEGIN(tickStart);
+   TickStreamUpdate(i);
+   PROBE_END(TD_STAGE_TICK, tickStart);
+   
+   PROBE_BEGIN(computeStart);
+   UpdateMARows(i);
+   UpdateIndicatorRows(i);
+   
+   // Delta da sessão; a cor mostra o sentido da janela móvel (pressão recente)
+   double deltaValue = CalculateDelta(i);
+   color deltaColor = (deltaStates[i].windowDelta >= 0) ? clrBuyGreen : clrSellRed;
+   SetMetric(TD_ROW_DELTA, i, deltaValue, deltaColor);
+   SetRowSignal(TD_ROW_DELTA, i, (deltaStates[i].windowDelta > 0) ? 1 : (deltaStates[i].windowDelta < 0) ? -1 : 0);
+   
+   // Liquidez Maior: preço com maior volume negociado na sessão (POC)
+   double poc = CalculateLiquidity(i);
+   if(poc > 0.0)
+      SetMetric(TD_ROW_LIQUIDEZ, i, poc, clrNormalText);
+   
+   // Spread atual com a mediana e o p95 da sessão; a cor mostra o percentil do spread atual
+   int spread = CalculateSpread(i);
+   if(spread >= 0)
    {
-      string symbol = symbolArray[i];
-      
-      // Exemplo de atualização para a linha "Score"
-      double score = CalculateScore(symbol); // Calcula o valor (atualmente com dados de exemplo)
-      string scoreText = (score > 50) ? "🟢 " + IntegerToString((int)score) : "🔴 " + IntegerToString((int)score);
-      color scoreColor = (score > 50) ? clrBuyGreen : clrSellRed;
-      // Atualiza o texto e a cor do objeto de texto correspondente
-      ObjectSetString(0, "TD_Score_" + IntegerToString(i) + "_Text", OBJPROP_TEXT, scoreText);
-      ObjectSetInteger(0, "TD_Score_" + IntegerToString(i) + "_Text", OBJPROP_COLOR, scoreColor);
-      
-      // =================================================================================
-      // EXERCÍCIO: Implementar a lógica de atualização para as outras métricas aqui.
-      // Descomente e adapte o bloco abaixo como exemplo para o Delta.
-      /*
-      double deltaValue = CalculateDelta(symbol);
-      string deltaText = DoubleToString(deltaValue, 0);
-      color deltaColor = (deltaValue >= 0) ? clrBuyGreen : clrSellRed;
-      ObjectSetString(0, "TD_Delta_" + IntegerToString(i) + "_Text", OBJPROP_TEXT, deltaText);
-      ObjectSetInteger(0, "TD_Delta_" + IntegerToString(i) + "_Text", OBJPROP_COLOR, deltaColor);
-      */
-      // Repita o processo para Pontuação, Pressão DOM, Liquidez, Spread, MAs, Indicadores e Resultados.
-      // =================================================================================
+      double pct = SpreadPercentile(spreadStats[i], spread);
+      color spreadColor = (pct <= 50.0) ? clrBuyGreen : (pct <= 90.0) ? clrNormalText : (pct <= 95.0) ? clrWarning : clrSellRed;
+      SetCellValue(TD_ROW_SPREAD, i, SpreadText(spread) + " (" + SpreadText(SpreadQuantile(spreadStats[i], 0.50)) + "/" +
+                   SpreadText(SpreadQuantile(spreadStats[i], 0.95)) + ")", spreadColor);
    }
+   
+   // Volume relativo ao mesmo minuto dos últimos dias: destaque acima de 1,5x
+   double relVolume;
+   if(RelVolumeRead(i, relVolume))
+      SetMetric(TD_ROW_VOLUME, i, relVolume, (relVolume >= 1.5) ? clrWarning : (relVolume >= 1.0) ? clrNormalText : clrNeutralText);
+   
+   // Resultado aberto do símbolo: só muda com o preço, então é atualizado junto com os ticks
+   ResultsUpdateFloating(i);
+   PROBE_END(TD_STAGE_COMPUTE, computeStart);
+   PROBE_SYMBOL(i, tickStart);
+   
+   // O Score não é calculado aqui: UpdateScores recalcula apenas os símbolos cujas entradas mudaram.
 }
 
 //+------------------------------------------------------------------+
-//| Funções de Cálculo (ATUALMENTE COM DADOS DE EXEMPLO)             |
+//| Funções de Cálculo por Símbolo                                   |
+//| Leem o estado mantido pelos motores (sinais do Score, delta,     |
+//| perfil de volume e spread) sem reler o histórico.                |
 //+------------------------------------------------------------------+
 
 /**
- * @brief Calcula o "Score" para um determinado símbolo.
- * @param symbol O símbolo para o qual o score será calculado.
- * @return Um valor de score (atualmente aleatório para demonstração).
- * @note SUBSTITUA a lógica de exemplo pela sua lógica de cálculo real.
+ * @brief Calcula o "Score" de um símbolo a partir dos sinais das linhas declaradas em ResetScoring.
+ * @param i       Índice do símbolo em symbolArray.
+ * @param bull    Recebe o número de entradas em alta.
+ * @param neutral Recebe o número de entradas neutras.
+ * @param bear    Recebe o número de entradas em baixa.
+ * @return Score de 0 (todas em baixa) a 100 (todas em alta).
  */
-double CalculateScore(string symbol)
+double CalculateScore(int i, int &bull, int &neutral, int &bear)
 {
-   // Lógica de exemplo: retorna um número aleatório entre 0 e 99.
-   MathSrand(GetTickCount()); // Inicializa o gerador de números aleatórios
-   return MathRand() % 100;
+   // Lote de um símbolo: o mesmo cálculo usado por UpdateScores
+   int symbols[1];
+   double out[SCORE_OUT_STRIDE];
+   symbols[0] = i;
+   ComputeScoresBatch(rowSignal, scoreFeeds, TD_ROW_COUNT, symbols, 1, out);
+   bull = (int)out[1];
+   neutral = (int)out[2];
+   bear = (int)out[3];
+   return out[0];
 }
 
 /**
- * @brief Calcula o "Delta" para um determinado símbolo.
- * @param symbol O símbolo para o qual o delta será calculado.
- * @return Um valor de delta (atualmente aleatório para demonstração).
- * @note SUBSTITUA a lógica de exemplo pela sua lógica de cálculo real.
+ * @brief Retorna o "Delta" de agressão acumulado na sessão para um símbolo.
+ * @param i Índice do símbolo em symbolArray.
+ * @return Volume agredido na compra menos volume agredido na venda (ver DeltaOnTick).
  */
-double CalculateDelta(string symbol)
+double CalculateDelta(int i)
 {
-   // Lógica de exemplo: retorna um número aleatório entre -1000 e 1000.
-   // Exemplo real: return SymbolInfoInteger(symbol, SYMBOL_ASK) - SymbolInfoInteger(symbol, SYMBOL_BID);
-   MathSrand(GetTickCount() + 1); // Usa uma seed diferente para não repetir o valor do Score
-   return (MathRand() % 2000) - 1000;
+   // Atualiza a janela móvel mesmo sem ticks novos, para que minutos antigos expirem
+   DeltaExpireWindow(deltaStates[i], CurrentTime() / 60);
+   return deltaStates[i].sessionDelta;
 }
 
 /**
- * @brief Calcula a "Liquidez" para um determinado símbolo.
- * @param symbol O símbolo para o qual a liquidez será calculada.
- * @return Um valor de liquidez (atualmente aleatório para demonstração).
- * @note SUBSTITUA a lógica de exemplo pela sua lógica de cálculo real.
+ * @brief Retorna a "Liquidez Maior" de um símbolo: o preço com maior volume na sessão (POC).
+ * @param i Índice do símbolo em symbolArray.
+ * @return Preço do POC, ou 0 se ainda não houve negócios na sessão. Custo O(1).
  */
-double CalculateLiquidity(string symbol)
+double CalculateLiquidity(int i)
 {
-   // Lógica de exemplo: retorna um número aleatório entre 1.0 e 1.1.
-   // Exemplo real: return SymbolInfoDouble(symbol, SYMBOL_VOLUME_REAL);
-   MathSrand(GetTickCount() + 2);
-   return 1.0 + (MathRand() % 1000) / 10000.0;
+   if(volumeProfiles[i].pocBin < 0) return 0.0;
+   return (volumeProfiles[i].baseTick + volumeProfiles[i].pocBin) * volumeProfiles[i].tickSize;
 }
 
 /**
- * @brief Calcula o "Spread" para um determinado símbolo.
- * @param symbol O símbolo para o qual o spread será calculado.
- * @return Um valor de spread (atualmente aleatório para demonstração).
- * @note SUBSTITUA a lógica de exemplo pela sua lógica de cálculo real.
+ * @brief Retorna o "Spread" atual de um símbolo, medido no último tick processado.
+ * @param i Índice do símbolo em symbolArray.
+ * @return Spread em ticks, ou -1 se ainda não houve cotação na sessão (ver SpreadOnTick).
  */
-double CalculateSpread(string symbol)
+int CalculateSpread(int i)
 {
-   // Lógica de exemplo: retorna um número aleatório entre 0.0 e 5.0.
-   // Exemplo real: return (SymbolInfoInteger(symbol, SYMBOL_SPREAD) * SymbolInfoDouble(symbol, SYMBOL_POINT));
-   MathSrand(GetTickCount() + 3);
-   return (MathRand() % 50) / 10.0;
+   return spreadStats[i].current;
 }
 
 // Implemente aqui as funções de cálculo para os outros indicadores:
@@ -809,12 +2126,4080 @@ double CalculateSpread(string symbol)
 // Ex: double CalculateADX(string symbol, ENUM_TIMEFRAMES timeframe, int period, int shift) { ... }
 
 //+------------------------------------------------------------------+
-//| Função de Desinicialização do Expert                             |
-//| É executada quando o EA é removido do gráfico.                   |
+//| Cache de Barras por (Símbolo, Tempo Gráfico)                     |
+//| Todas as linhas leem OHLCV por este cache. Cada série é          |
+//| sincronizada com o terminal no máximo uma vez por frame, lendo   |
+//| só as duas barras mais recentes: a barra fechada é consolidada e |
+//| a barra em formação é corrigida. O histórico completo só é       |
+//| copiado na primeira leitura ou quando as barras não conferem.    |
 //+------------------------------------------------------------------+
-void OnDeinit(const int reason)
+
+/**
+ * @brief Esvazia o cache de barras e seus contadores.
+ */
+void ResetBarCache()
+{
+   ArrayFree(barCache);
+   barCacheIndex.Clear();
+   barCacheHits = 0;
+   barCacheMisses = 0;
+   barCacheReportAt = GetMicrosecondCount();
+}
+
+/**
+ * @brief Retorna a série do cache para (símbolo, tempo gráfico), criando-a se necessário.
+ * @param symbol Símbolo.
+ * @param tf     Tempo gráfico.
+ * @param depth  Quantidade mínima de barras que o leitor precisa.
+ * @return Índice da série em barCache.
+ */
+int BarCacheGet(string symbol, ENUM_TIMEFRAMES tf, int depth)
+{
+   if(tf == PERIOD_CURRENT) tf = Period();
+   string key = symbol + "|" + IntegerToString((int)tf);
+   int slot;
+   if(!barCacheIndex.TryGetValue(key, slot))
+   {
+      slot = ArraySize(barCache);
+      ArrayResize(barCache, slot + 1, 16);
+      barCache[slot].symbol = symbol;
+      barCache[slot].tf = tf;
+      barCache[slot].capacity = 0;
+      barCache[slot].head = 0;
+      barCache[slot].count = 0;
+      barCache[slot].syncedFrame = 0;
+      barCache[slot].closedCount = 0;
+      barCache[slot].reloadVersion = 0;
+      barCache[slot].needsReload = true;
+      barCacheIndex.Add(key, slot);
+   }
+   
+   // Um leitor que precisa de mais barras aumenta o buffer e força uma recarga
+   if(depth > barCache[slot].capacity)
+   {
+      barCache[slot].capacity = depth;
+      ArrayResize(barCache[slot].rates, depth);
+      barCache[slot].needsReload = true;
+   }
+   return slot;
+}
+
+/**
+ * @brief Recarrega todo o histórico da série (capacity barras).
+ * @return true se alguma barra foi copiada.
+ */
+bool BarCacheReload(int slot)
+{
+   MqlRates rates[];
+   barCacheMisses++;
+   int got = CopyRates(barCache[slot].symbol, barCache[slot].tf, 0, barCache[slot].capacity, rates);
+   if(got <= 0) return false;
+   
+   for(int k = 0; k < got; k++)
+      barCache[slot].rates[k] = rates[k];
+   barCache[slot].head = got - 1;
+   barCache[slot].count = got;
+   barCache[slot].closedCount = 0;
+   barCache[slot].reloadVersion++;
+   barCache[slot].needsReload = false;
+   return true;
+}
+
+/**
+ * @brief Sincroniza a série com o terminal, no máximo uma vez por frame.
+ * @param slot Índice da série em barCache.
+ * @return true se a série tem barras válidas.
+ */
+bool BarCacheSync(int slot)
+{
+   // Já sincronizada neste frame: os leitores seguintes não geram cópias
+   if(barCache[slot].syncedFrame == frameNumber && !barCache[slot].needsReload)
+   {
+      barCacheHits++;
+      return barCache[slot].count > 0;
+   }
+   barCache[slot].syncedFrame = frameNumber;
+   
+   if(barCache[slot].needsReload || barCache[slot].count < 2)
+      return BarCacheReload(slot);
+   
+   MqlRates rates[];
+   barCacheMisses++;
+   if(CopyRates(barCache[slot].symbol, barCache[slot].tf, 0, 2, rates) < 2)
+      return true; // Mantém as barras atuais
+   
+   int cap = barCache[slot].capacity;
+   int head = barCache[slot].head;
+   int prev = (head - 1 + cap) % cap;
+   
+   if(rates[1].time == barCache[slot].rates[head].time)
+   {
+      // Histórico reescrito: a última barra fechada mudou depois de consolidada
+      if(rates[0].time != barCache[slot].rates[prev].time || rates[0].close != barCache[slot].rates[prev].close)
+         return BarCacheReload(slot);
+      // Mesmo candle: corrige a barra em formação
+      barCache[slot].rates[head] = rates[1];
+   }
+   else if(rates[0].time == barCache[slot].rates[head].time)
+   {
+      // Candle novo: consolida o anterior e abre o atual no lugar da barra mais antiga
+      barCache[slot].rates[head] = rates[0];
+      head = (head + 1) % cap;
+      barCache[slot].rates[head] = rates[1];
+      barCache[slot].head = head;
+      if(barCache[slot].count < cap) barCache[slot].count++;
+      barCache[slot].closedCount++;
+   }
+   else
+      return BarCacheReload(slot); // Barras perdidas ou fora de ordem
+   
+   return true;
+}
+
+/**
+ * @brief Lê uma barra do cache (shift 0 = barra em formação, 1 = última fechada, ...).
+ * @param slot  Índice da série em barCache.
+ * @param shift Deslocamento a partir da barra mais recente (deve ser menor que count).
+ * @param bar   Recebe a barra.
+ */
+void BarCacheBar(int slot, int shift, MqlRates &bar)
+{
+   int cap = barCache[slot].capacity;
+   bar = barCache[slot].rates[(barCache[slot].head - shift + cap) % cap];
+}
+
+/**
+ * @brief Registra no diário, periodicamente, quantas cópias do terminal o cache evitou por segundo.
+ */
+void BarCacheReport()
+{
+   ulong now = GetMicrosecondCount();
+   double elapsed = (now - barCacheReportAt) / 1000000.0;
+   if(elapsed < STATS_REPORT_SEC) return;
+   
+   LOG_INFO(StringFormat("[0600] Cache de barras: %d séries, %.1f acertos/s, %.1f cópias/s",
+                         ArraySize(barCache), barCacheHits / elapsed, barCacheMisses / elapsed));
+   barCacheHits = 0;
+   barCacheMisses = 0;
+   barCacheReportAt = now;
+}
+
+//+------------------------------------------------------------------+
+//| Motor Incremental de Médias, Bollinger e ATR                     |
+//| Cada símbolo mantém janelas circulares de tamanho fixo. A cada   |
+//| tick apenas a barra em formação é corrigida e a cada barra nova  |
+//| um valor entra na janela, ambos em O(1). O histórico completo só |
+//| é relido quando a sequência de barras não confere (histórico     |
+//| reescrito ou barras perdidas).                                   |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Inicializa uma janela circular vazia com a capacidade informada.
+ */
+void WindowInit(RollingWindow &w, int size)
+{
+   w.size = MathMax(size, 1);
+   ArrayResize(w.buf, w.size);
+   ArrayInitialize(w.buf, 0.0);
+   w.head = w.size - 1;
+   w.count = 0;
+   w.sum = 0.0;
+   w.sumSq = 0.0;
+}
+
+/**
+ * @brief Adiciona um valor à janela, descartando o mais antigo se ela estiver cheia.
+ */
+void WindowPush(RollingWindow &w, double v)
+{
+   w.head = (w.head + 1) % w.size;
+   if(w.count == w.size)
+   {
+      double old = w.buf[w.head];
+      w.sum -= old;
+      w.sumSq -= old * old;
+   }
+   else
+      w.count++;
+   w.buf[w.head] = v;
+   w.sum += v;
+   w.sumSq += v * v;
+   
+   // Ao completar uma volta, refaz as somas para não acumular erro de arredondamento (O(1) amortizado)
+   if(w.head == w.size - 1 && w.count == w.size)
+   {
+      w.sum = 0.0;
+      w.sumSq = 0.0;
+      for(int k = 0; k < w.size; k++)
+      {
+         w.sum += w.buf[k];
+         w.sumSq += w.buf[k] * w.buf[k];
+      }
+   }
+}
+
+/**
+ * @brief Substitui o valor mais recente da janela (barra em formação).
+ */
+void WindowPatch(RollingWindow &w, double v)
+{
+   if(w.count == 0) { WindowPush(w, v); return; }
+   double old = w.buf[w.head];
+   w.buf[w.head] = v;
+   w.sum += v - old;
+   w.sumSq += v * v - old * old;
+}
+
+/**
+ * @brief Média dos valores da janela.
+ */
+double WindowMean(const RollingWindow &w)
+{
+   return (w.count > 0) ? w.sum / w.count : 0.0;
+}
+
+/**
+ * @brief Desvio-padrão populacional dos valores da janela (como nas Bandas de Bollinger).
+ */
+double WindowStdDev(const RollingWindow &w)
+{
+   if(w.count == 0) return 0.0;
+   double mean = w.sum / w.count;
+   double var = w.sumSq / w.count - mean * mean;
+   return (var > 0.0) ? MathSqrt(var) : 0.0;
+}
+
+/**
+ * @brief True Range de uma barra em relação ao fechamento anterior.
+ */
+double TrueRange(double high, double low, double prevClose)
+{
+   if(prevClose <= 0.0) return high - low;
+   return MathMax(high, prevClose) - MathMin(low, prevClose);
+}
+
+/**
+ * @brief Reinicia o estado de uma série, mantendo o tempo gráfico e as médias configuradas.
+ */
+void SeriesReset(IndicatorSeries &s)
+{
+   s.ready = false;
+   s.barTime = 0;
+   s.seenClosed = 0;
+   s.seenReload = -1;
+   s.close = 0.0;
+   s.closedClose = 0.0;
+   s.restored = false;
+   for(int m = 0; m < ArraySize(s.ma); m++)
+   {
+      WindowInit(s.ma[m].win, s.ma[m].period);
+      s.ma[m].emaClosed = 0.0;
+      s.ma[m].emaSeeded = false;
+      s.ma[m].value = 0.0;
+   }
+   if(s.hasBands)
+   {
+      WindowInit(s.bb, BBPeriod);
+      s.atr.period = MathMax(ATRPeriod, 1);
+      s.atr.atrClosed = 0.0;
+      s.atr.prevClose = 0.0;
+      s.atr.seedCount = 0;
+      s.atr.seedSum = 0.0;
+      s.atr.value = 0.0;
+      SwingReset(s.swing, SwingStrength);
+   }
+}
+
+/**
+ * @brief Configura uma série com o tempo gráfico e os períodos das médias, sem associá-la ao cache.
+ */
+void SeriesConfigure(IndicatorSeries &s, ENUM_TIMEFRAMES tf, const int &periods[], bool hasBands)
+{
+   s.tf = tf;
+   s.hasBands = hasBands;
+   ArrayResize(s.ma, ArraySize(periods));
+   for(int m = 0; m < ArraySize(periods); m++)
+      s.ma[m].period = MathMax(periods[m], 1);
+   SeriesReset(s);
+}
+
+/**
+ * @brief Configura uma série com o tempo gráfico e os períodos das médias
+ *        e a associa à série de barras do cache.
+ */
+void SeriesSetup(IndicatorSeries &s, string symbol, ENUM_TIMEFRAMES tf, const int &periods[], bool hasBands)
+{
+   SeriesConfigure(s, tf, periods, hasBands);
+   s.cacheSlot = BarCacheGet(symbol, tf, SeriesDepth(s));
+}
+
+/**
+ * @brief Número de barras necessário para reconstruir a série a partir do histórico.
+ */
+int SeriesDepth(const IndicatorSeries &s)
+{
+   int depth = s.hasBands ? MathMax(BBPeriod, ATRPeriod) : 1;
+   for(int m = 0; m < ArraySize(s.ma); m++)
+      depth = MathMax(depth, s.ma[m].period);
+   // A EMA precisa de barras extras para convergir
+   if(MAMethod == MODE_EMA) depth *= 3;
+   return depth + 1;
+}
+
+/**
+ * @brief Abre uma nova barra: cada janela recebe uma posição nova.
+ */
+void SeriesOpenBar(IndicatorSeries &s, const MqlRates &bar)
+{
+   for(int m = 0; m < ArraySize(s.ma); m++)
+      WindowPush(s.ma[m].win, bar.close);
+   if(s.hasBands)
+      WindowPush(s.bb, bar.close);
+   s.barTime = bar.time;
+}
+
+/**
+ * @brief Atualiza a barra em formação com os valores mais recentes.
+ */
+void SeriesPatchBar(IndicatorSeries &s, const MqlRates &bar)
+{
+   s.close = bar.close;
+   for(int m = 0; m < ArraySize(s.ma); m++)
+   {
+      WindowPatch(s.ma[m].win, bar.close);
+      if(MAMethod == MODE_EMA)
+      {
+         double k = 2.0 / (s.ma[m].period + 1.0);
+         s.ma[m].value = s.ma[m].emaSeeded ? s.ma[m].emaClosed + k * (bar.close - s.ma[m].emaClosed) : bar.close;
+      }
+      else
+         s.ma[m].value = WindowMean(s.ma[m].win);
+   }
+   if(s.hasBands)
+   {
+      WindowPatch(s.bb, bar.close);
+      double tr = TrueRange(bar.high, bar.low, s.atr.prevClose);
+      int p = s.atr.period;
+      s.atr.value = (s.atr.seedCount < p) ? (s.atr.seedSum + tr) / (s.atr.seedCount + 1)
+                                           : (s.atr.atrClosed * (p - 1) + tr) / p;
+   }
+}
+
+/**
+ * @brief Fecha a barra em formação com seus valores finais e consolida EMA e ATR.
+ */
+void SeriesCloseBar(IndicatorSeries &s, const MqlRates &bar)
+{
+   SeriesPatchBar(s, bar);
+   s.closedClose = bar.close;
+   for(int m = 0; m < ArraySize(s.ma); m++)
+   {
+      s.ma[m].emaClosed = s.ma[m].value;
+      s.ma[m].emaSeeded = true;
+   }
+   if(s.hasBands)
+   {
+      double tr = TrueRange(bar.high, bar.low, s.atr.prevClose);
+      if(s.atr.seedCount < s.atr.period)
+      {
+         s.atr.seedSum += tr;
+         s.atr.seedCount++;
+         s.atr.atrClosed = s.atr.seedSum / s.atr.seedCount;
+      }
+      else
+         s.atr.atrClosed = (s.atr.atrClosed * (s.atr.period - 1) + tr) / s.atr.period;
+      s.atr.prevClose = bar.close;
+      SwingCloseBar(s.swing, bar);
+   }
+}
+
+/**
+ * @brief Reconstrói a série inteira a partir das barras do cache (recálculo completo).
+ */
+void SeriesRebuild(IndicatorSeries &s)
+{
+   SeriesReset(s);
+   int n = barCache[s.cacheSlot].count;
+   MqlRates bar;
+   for(int shift = n - 1; shift >= 0; shift--)
+   {
+      BarCacheBar(s.cacheSlot, shift, bar);
+      SeriesOpenBar(s, bar);
+      if(shift > 0)
+         SeriesCloseBar(s, bar);
+      else
+         SeriesPatchBar(s, bar);
+   }
+   s.seenClosed = barCache[s.cacheSlot].closedCount;
+   s.seenReload = barCache[s.cacheSlot].reloadVersion;
+   s.ready = (n > 0);
+}
+
+/**
+ * @brief Atualiza a série com as barras do cache: fecha as barras que fecharam desde a
+ *        última leitura (normalmente uma) e corrige a barra em formação. Custo O(1);
+ *        só é reconstruída quando o cache recarregou o histórico.
+ * @return true se a série tem valores válidos.
+ */
+bool SeriesUpdate(IndicatorSeries &s)
+{
+   if(!BarCacheSync(s.cacheSlot)) return s.ready; // Mantém os últimos valores
+   
+   long newClosed = barCache[s.cacheSlot].closedCount - s.seenClosed;
+   bool aligned = s.ready && s.seenReload == barCache[s.cacheSlot].reloadVersion;
+   
+   // Estado restaurado do snapshot: só as barras fechadas depois dele são processadas
+   if(s.restored)
+   {
+      newClosed = SeriesResumeShift(s);
+      aligned = (newClosed >= 0);
+      s.restored = false;
+   }
+   
+   if(!aligned || newClosed >= barCache[s.cacheSlot].count)
+   {
+      SeriesRebuild(s);
+      return s.ready;
+   }
+   
+   MqlRates bar;
+   if(newClosed > 0)
+   {
+      // A barra que estava em formação agora está em `newClosed`; as seguintes abrem e fecham
+      BarCacheBar(s.cacheSlot, (int)newClosed, bar);
+      SeriesCloseBar(s, bar);
+      for(int shift = (int)newClosed - 1; shift >= 1; shift--)
+      {
+         BarCacheBar(s.cacheSlot, shift, bar);
+         SeriesOpenBar(s, bar);
+         SeriesCloseBar(s, bar);
+      }
+      BarCacheBar(s.cacheSlot, 0, bar);
+      SeriesOpenBar(s, bar);
+   }
+   s.seenClosed = barCache[s.cacheSlot].closedCount;
+   s.seenReload = barCache[s.cacheSlot].reloadVersion;
+   
+   // Corrige a barra em formação com o último preço
+   BarCacheBar(s.cacheSlot, 0, bar);
+   SeriesPatchBar(s, bar);
+   return true;
+}
+
+/**
+ * @brief Localiza no cache a barra que estava em formação quando o snapshot foi salvo.
+ *        A barra anterior a ela precisa ter o mesmo fechamento guardado no snapshot.
+ * @return Quantas barras fecharam desde o snapshot, ou -1 se o estado não confere.
+ */
+long SeriesResumeShift(const IndicatorSeries &s)
+{
+   int n = barCache[s.cacheSlot].count;
+   MqlRates bar;
+   for(int k = 0; k + 1 < n; k++)
+   {
+      BarCacheBar(s.cacheSlot, k, bar);
+      if(bar.time < s.barTime) return -1; // Passou do horário: a barra não existe mais
+      if(bar.time != s.barTime) continue;
+      BarCacheBar(s.cacheSlot, k + 1, bar);
+      return (bar.close == s.closedClose) ? k : -1;
+   }
+   return -1;
+}
+
+/**
+ * @brief Maior diferença relativa entre os valores de duas séries com a mesma configuração.
+ */
+double SeriesDeviation(const IndicatorSeries &a, const IndicatorSeries &b)
+{
+   double x[], y[];
+   int n = ArraySize(a.ma);
+   ArrayResize(x, n + 4);
+   ArrayResize(y, n + 4);
+   for(int m = 0; m < n; m++)
+   {
+      x[m] = a.ma[m].value;
+      y[m] = b.ma[m].value;
+   }
+   x[n] = a.close;                  y[n] = b.close;
+   x[n + 1] = WindowMean(a.bb);     y[n + 1] = WindowMean(b.bb);
+   x[n + 2] = WindowStdDev(a.bb);   y[n + 2] = WindowStdDev(b.bb);
+   x[n + 3] = a.atr.value;          y[n + 3] = b.atr.value;
+   
+   double deviation = 0.0;
+   for(int k = 0; k < n + 4; k++)
+      deviation = MathMax(deviation, MathAbs(x[k] - y[k]) / MathMax(MathAbs(y[k]), 1e-12));
+   return deviation;
+}
+
+/**
+ * @brief Compara duas estruturas de mercado: tendência, rompimento e pilha de pivôs.
+ */
+bool SwingMatches(const SwingState &a, const SwingState &b)
+{
+   if(a.trend != b.trend || a.hasBreak != b.hasBreak || a.breakLevel != b.breakLevel || a.pivotCount != b.pivotCount)
+      return false;
+   for(int k = 0; k < a.pivotCount; k++)
+   {
+      int x = (a.pivotHead - k + SWING_MAX_PIVOTS) % SWING_MAX_PIVOTS;
+      int y = (b.pivotHead - k + SWING_MAX_PIVOTS) % SWING_MAX_PIVOTS;
+      if(a.pivots[x].price != b.pivots[y].price || a.pivots[x].time != b.pivots[y].time ||
+         a.pivots[x].isHigh != b.pivots[y].isHigh || a.pivots[x].broken != b.pivots[y].broken)
+         return false;
+   }
+   return true;
+}
+
+/**
+ * @brief Verifica o cálculo incremental das séries: reproduz barras sintéticas em uma série
+ *        temporária do cache (ora corrigindo a barra em formação, ora fechando uma ou duas
+ *        barras) e a cada passo compara SeriesUpdate com SeriesRebuild sobre as mesmas barras,
+ *        inclusive a estrutura de mercado. Por fim mede SwingCloseBar sozinho, reproduzindo as
+ *        barras fechadas em uma estrutura nova, e a compara com a reconstrução.
+ *        Grava os tempos e as divergências na tabela de verificações do benchmark.
+ * @param file Arquivo CSV do benchmark.
+ * @return Quantidade de comparações com diferença (acima de SELFCHECK_TOLERANCE nos valores).
+ */
+int SeriesSelfCheck(int file)
+{
+   // Série temporária fora do índice do cache e com espaço para todas as barras: a reconstrução
+   // vê exatamente o histórico que o cálculo incremental já incorporou
+   int cap = SELFCHECK_BARS + 1;
+   int slot = ArraySize(barCache);
+   ArrayResize(barCache, slot + 1, 16);
+   barCache[slot].symbol = "";
+   barCache[slot].tf = MATimeframe;
+   barCache[slot].capacity = cap;
+   ArrayResize(barCache[slot].rates, cap);
+   barCache[slot].head = 0;
+   barCache[slot].count = 1;
+   barCache[slot].closedCount = 0;
+   barCache[slot].reloadVersion = 1;
+   barCache[slot].needsReload = false;
+   barCache[slot].syncedFrame = frameNumber; // BarCacheSync não copia do terminal
+   ulong hits = barCacheHits;
+   
+   int periods[4];
+   periods[0] = MAPeriod;
+   periods[1] = 50;
+   periods[2] = 100;
+   periods[3] = 200;
+   IndicatorSeries incremental, rebuilt;
+   SeriesConfigure(incremental, MATimeframe, periods, true);
+   SeriesConfigure(rebuilt, MATimeframe, periods, true);
+   incremental.cacheSlot = slot;
+   rebuilt.cacheSlot = slot;
+   
+   MathSrand(SYNTH_SEED);
+   int seconds = PeriodSeconds(MATimeframe);
+   double price = 100.0;
+   MqlRates bar;
+   ZeroMemory(bar);
+   bar.time = (datetime)seconds;
+   bar.open = bar.high = bar.low = bar.close = price;
+   barCache[slot].rates[0] = bar;
+   
+   int steps = 0, mismatches = 0, swingMismatches = 0;
+   double worst = 0.0;
+   ulong updateUs = 0, rebuildUs = 0;
+   while(barCache[slot].count < cap)
+   {
+      int closes = MathRand() % 4; // 0/1: só corrige a barra em formação, 2: fecha uma, 3: fecha duas
+      closes = (closes < 2) ? 0 : closes - 1;
+      for(int c = 0; c < closes && barCache[slot].count < cap; c++)
+      {
+         bar.time += seconds;
+         bar.open = bar.high = bar.low = bar.close = price;
+         barCache[slot].head++;
+         barCache[slot].count++;
+         barCache[slot].closedCount++;
+      }
+      price += (MathRand() - 16383.5) / 16383.5 * 0.5;
+      bar.close = price;
+      bar.high = MathMax(bar.high, price);
+      bar.low = MathMin(bar.low, price);
+      barCache[slot].rates[barCache[slot].head] = bar;
+      
+      ulong t = GetMicrosecondCount();
+      SeriesUpdate(incremental);
+      updateUs += GetMicrosecondCount() - t;
+      t = GetMicrosecondCount();
+      SeriesRebuild(rebuilt);
+      rebuildUs += GetMicrosecondCount() - t;
+      
+      double deviation = SeriesDeviation(incremental, rebuilt);
+      worst = MathMax(worst, deviation);
+      if(deviation > SELFCHECK_TOLERANCE) mismatches++;
+      if(!SwingMatches(incremental.swing, rebuilt.swing)) swingMismatches++;
+      steps++;
+   }
+   
+   // Estrutura de mercado sozinha sobre as barras fechadas (a última está em formação)
+   SwingState replay;
+   SwingReset(replay, SwingStrength);
+   int closed = barCache[slot].count - 1;
+   ulong t0 = GetMicrosecondCount();
+   for(int k = 0; k < closed; k++)
+      SwingCloseBar(replay, barCache[slot].rates[k]);
+   ulong swingUs = GetMicrosecondCount() - t0;
+   if(!SwingMatches(replay, rebuilt.swing)) swingMismatches++;
+   
+   ArrayResize(barCache, slot);
+   barCacheHits = hits;
+   
+   LOG_INFO(StringFormat("[0510] Séries: %d passos sobre %d barras, incremental %.2f µs, reconstrução %.2f µs por passo, maior diferença relativa %.2e",
+                         steps, SELFCHECK_BARS, (double)updateUs / steps, (double)rebuildUs / steps, worst));
+   BenchmarkCase(file, "series", steps, (double)updateUs / steps, mismatches);
+   BenchmarkCase(file, "swing", closed, (double)swingUs / MathMax(closed, 1), swingMismatches);
+   return mismatches + swingMismatches;
+}
+
+/**
+ * @brief Prepara o estado incremental de médias/bandas de todos os símbolos.
+ */
+void ResetIndicatorSeries()
+{
+   int mainPeriods[4];
+   mainPeriods[0] = MAPeriod;
+   mainPeriods[1] = 50;
+   mainPeriods[2] = 100;
+   mainPeriods[3] = 200;
+   int htfPeriods[1];
+   htfPeriods[0] = MAHigherTFPeriod;
+   
+   ArrayResize(mainSeries, totalSymbols);
+   ArrayResize(htfSeries, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      SeriesSetup(mainSeries[i], symbolArray[i], MATimeframe, mainPeriods, true);
+      SeriesSetup(htfSeries[i], symbolArray[i], MAHigherTF, htfPeriods, false);
+   }
+}
+
+/**
+ * @brief Formata uma média na célula: verde com o preço acima, vermelho abaixo.
+ */
+void SetMACell(ENUM_TD_ROW row, int i, double price, double ma)
+{
+   SetMetric(row, i, ma, (price >= ma) ? clrBuyGreen : clrSellRed);
+   SetRowSignal(row, i, (price > ma) ? 1 : (price < ma) ? -1 : 0);
+}
+
+/**
+ * @brief Atualiza as linhas de médias, Bollinger e ATR de um símbolo.
+ * @param i Índice do símbolo em symbolArray.
+ */
+void UpdateMARows(int i)
+{
+   if(SeriesUpdate(mainSeries[i]))
+   {
+      double price = mainSeries[i].close;
+      SetMACell(TD_ROW_MA, i, price, mainSeries[i].ma[0].value);
+      SetMACell(TD_ROW_MA50, i, price, mainSeries[i].ma[1].value);
+      SetMACell(TD_ROW_MA100, i, price, mainSeries[i].ma[2].value);
+      SetMACell(TD_ROW_MA200, i, price, mainSeries[i].ma[3].value);
+      
+      // Bollinger: posição do preço dentro das bandas (%B, 0 = banda inferior, 100 = superior)
+      double mid = WindowMean(mainSeries[i].bb);
+      double dev = BBDeviation * WindowStdDev(mainSeries[i].bb);
+      double percentB = (dev > 0.0) ? (price - (mid - dev)) / (2.0 * dev) * 100.0 : 50.0;
+      SetMetric(TD_ROW_BB, i, percentB, (percentB >= 50.0) ? clrBuyGreen : clrSellRed);
+      
+      SetMetric(TD_ROW_ATR, i, mainSeries[i].atr.value, clrNormalText);
+      
+      // PriceAction: tendência da estrutura de topos e fundos, com o último nível rompido
+      int trend = mainSeries[i].swing.trend;
+      string state = (trend > 0) ? "Alta" : (trend < 0) ? "Baixa" : "Lateral";
+      string text = mainSeries[i].swing.hasBreak ? state + " " + DoubleToString(mainSeries[i].swing.breakLevel, sourceDigits[i]) : state;
+      SetCellValue(TD_ROW_PRICEACTION, i, text, TrendColor(state));
+      SetRowSignal(TD_ROW_PRICEACTION, i, trend);
+   }
+   
+   if(SeriesUpdate(htfSeries[i]))
+      SetMACell(TD_ROW_MA_HTF, i, htfSeries[i].close, htfSeries[i].ma[0].value);
+}
+
+//+------------------------------------------------------------------+
+//| Estrutura de Mercado (PriceAction)                               |
+//| A cada barra fechada a barra do meio da janela de 2N+1 barras é  |
+//| testada como topo/fundo (N = SwingStrength). Os pivôs ficam em   |
+//| uma pilha limitada; topos e fundos ascendentes = Alta,           |
+//| descendentes = Baixa. Um fechamento além do último pivô antecipa |
+//| a tendência e registra o nível rompido. Duas filas monotônicas   |
+//| guardam a máxima/mínima da janela (cada barra entra e sai uma    |
+//| vez) e a pilha de pivôs tem tamanho fixo: custo O(1) amortizado  |
+//| por barra, independente de N, sem reler o histórico.             |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Esvazia a estrutura de mercado.
+ * @param strength Barras de cada lado que confirmam um pivô.
+ */
+void SwingReset(SwingState &w, int strength)
+{
+   w.strength = MathMax(strength, 1);
+   int size = 2 * w.strength + 1;
+   ArrayResize(w.barHigh, size);
+   ArrayResize(w.barLow, size);
+   ArrayResize(w.barTime, size);
+   w.barHead = size - 1;
+   w.barCount = 0;
+   SwingRebuildQueues(w);
+   w.pivotHead = SWING_MAX_PIVOTS - 1;
+   w.pivotCount = 0;
+   w.trend = 0;
+   w.hasBreak = false;
+   w.breakLevel = 0.0;
+}
+
+/**
+ * @brief Máxima (ou mínima) de uma barra da janela pelo número de sequência.
+ */
+double SwingBarValue(const SwingState &w, long seq, bool isHigh)
+{
+   int size = ArraySize(w.barHigh);
+   int pos = (w.barHead - (int)(w.barSeq - seq) + size) % size;
+   return isHigh ? w.barHigh[pos] : w.barLow[pos];
+}
+
+/**
+ * @brief Incorpora a barra mais recente (barSeq) à fila de um lado: descarta a barra que saiu da
+ *        janela e as candidatas que a nova supera. Empates mantêm a mais antiga à frente, então a
+ *        frente é a primeira ocorrência da máxima (side 0) ou da mínima (side 1) da janela.
+ */
+void SwingQueuePush(SwingState &w, int side)
+{
+   int size = ArraySize(w.barHigh);
+   int base = side * size;
+   // Só a candidata da frente pode ter saído da janela (uma barra entra, uma sai)
+   if(w.queueCount[side] > 0 && w.barSeq - w.queue[base + w.queueFirst[side]] >= size)
+   {
+      w.queueFirst[side] = (w.queueFirst[side] + 1) % size;
+      w.queueCount[side]--;
+   }
+   double v = SwingBarValue(w, w.barSeq, side == 0);
+   while(w.queueCount[side] > 0)
+   {
+      int back = (w.queueFirst[side] + w.queueCount[side] - 1) % size;
+      double b = SwingBarValue(w, w.queue[base + back], side == 0);
+      if((side == 0) ? (b >= v) : (b <= v)) break;
+      w.queueCount[side]--;
+   }
+   w.queue[base + (w.queueFirst[side] + w.queueCount[side]) % size] = w.barSeq;
+   w.queueCount[side]++;
+}
+
+/**
+ * @brief Refaz as filas a partir das barras da janela (início e estado restaurado do snapshot).
+ */
+void SwingRebuildQueues(SwingState &w)
+{
+   int size = ArraySize(w.barHigh);
+   int head = w.barHead;
+   ArrayResize(w.queue, 2 * size);
+   ArrayInitialize(w.queueFirst, 0);
+   ArrayInitialize(w.queueCount, 0);
+   for(int k = w.barCount - 1; k >= 0; k--)
+   {
+      w.barHead = (head - k + size) % size;
+      w.barSeq = w.barCount - 1 - k;
+      SwingQueuePush(w, 0);
+      SwingQueuePush(w, 1);
+   }
+   w.barHead = head;
+   w.barSeq = w.barCount - 1;
+}
+
+/**
+ * @brief Posição na pilha do n-ésimo pivô mais recente de um lado.
+ * @param isHigh true para topos, false para fundos.
+ * @param nth    0 = mais recente.
+ * @return Índice em pivots ou -1 se não existe.
+ */
+int SwingFind(const SwingState &w, bool isHigh, int nth)
+{
+   for(int k = 0; k < w.pivotCount; k++)
+   {
+      int idx = (w.pivotHead - k + SWING_MAX_PIVOTS) % SWING_MAX_PIVOTS;
+      if(w.pivots[idx].isHigh == isHigh && nth-- == 0) return idx;
+   }
+   return -1;
+}
+
+/**
+ * @brief Empilha um pivô confirmado (o mais antigo é descartado com a pilha cheia) e
+ *        reavalia a sequência: topo e fundo mais altos que os anteriores = Alta,
+ *        mais baixos = Baixa, sequência mista = Lateral.
+ */
+void SwingPush(SwingState &w, double price, datetime time, bool isHigh)
+{
+   w.pivotHead = (w.pivotHead + 1) % SWING_MAX_PIVOTS;
+   w.pivots[w.pivotHead].price = price;
+   w.pivots[w.pivotHead].time = time;
+   w.pivots[w.pivotHead].isHigh = isHigh;
+   w.pivots[w.pivotHead].broken = false;
+   if(w.pivotCount < SWING_MAX_PIVOTS) w.pivotCount++;
+   
+   int h0 = SwingFind(w, true, 0), h1 = SwingFind(w, true, 1);
+   int l0 = SwingFind(w, false, 0), l1 = SwingFind(w, false, 1);
+   if(h1 < 0 || l1 < 0) return; // Ainda sem dois topos e dois fundos
+   
+   bool higherHigh = w.pivots[h0].price > w.pivots[h1].price;
+   bool higherLow  = w.pivots[l0].price > w.pivots[l1].price;
+   bool lowerHigh  = w.pivots[h0].price < w.pivots[h1].price;
+   bool lowerLow   = w.pivots[l0].price < w.pivots[l1].price;
+   w.trend = (higherHigh && higherLow) ? 1 : (lowerHigh && lowerLow) ? -1 : 0;
+}
+
+/**
+ * @brief Incorpora uma barra fechada: verifica o rompimento dos últimos pivôs pelo
+ *        fechamento e confirma a barra do meio da janela como topo e/ou fundo.
+ */
+void SwingCloseBar(SwingState &w, const MqlRates &bar)
+{
+   // Rompimento: fechamento acima do último topo ou abaixo do último fundo (cada pivô rompe uma vez)
+   int h = SwingFind(w, true, 0);
+   if(h >= 0 && !w.pivots[h].broken && bar.close > w.pivots[h].price)
+   {
+      w.pivots[h].broken = true;
+      w.trend = 1;
+      w.hasBreak = true;
+      w.breakLevel = w.pivots[h].price;
+   }
+   int l = SwingFind(w, false, 0);
+   if(l >= 0 && !w.pivots[l].broken && bar.close < w.pivots[l].price)
+   {
+      w.pivots[l].broken = true;
+      w.trend = -1;
+      w.hasBreak = true;
+      w.breakLevel = w.pivots[l].price;
+   }
+   
+   int size = ArraySize(w.barHigh);
+   w.barHead = (w.barHead + 1) % size;
+   w.barSeq++;
+   w.barHigh[w.barHead] = bar.high;
+   w.barLow[w.barHead] = bar.low;
+   w.barTime[w.barHead] = bar.time;
+   SwingQueuePush(w, 0);
+   SwingQueuePush(w, 1);
+   if(w.barCount < size) w.barCount++;
+   if(w.barCount < size) return;
+   
+   // Barra do meio: topo se supera as N anteriores e não é superada pelas N seguintes, ou seja, se é
+   // a primeira ocorrência da máxima da janela (fundo, o inverso) — a frente de cada fila
+   long midSeq = w.barSeq - w.strength;
+   int mid = (w.barHead - w.strength + size) % size;
+   bool isHigh = w.queue[w.queueFirst[0]] == midSeq;
+   bool isLow = w.queue[size + w.queueFirst[1]] == midSeq;
+   if(isHigh) SwingPush(w, w.barHigh[mid], w.barTime[mid], true);
+   if(isLow) SwingPush(w, w.barLow[mid], w.barTime[mid], false);
+}
+
+//+------------------------------------------------------------------+
+//| Motor de Pontuação (Score, Pontuação, Status e Ações)            |
+//| As linhas publicam um sinal (+1/-1/0) com carimbo de versão. O   |
+//| Score declara de quais linhas depende e só é recalculado quando  |
+//| alguma delas mudou de sinal desde o último cálculo.              |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Declara as entradas do Score e zera sinais e versões.
+ */
+void ResetScoring()
+{
+   ArrayInitialize(rowFeedsScore, false);
+   rowFeedsScore[TD_ROW_MA]       = true;
+   rowFeedsScore[TD_ROW_MA50]     = true;
+   rowFeedsScore[TD_ROW_MA100]    = true;
+   rowFeedsScore[TD_ROW_MA200]    = true;
+   rowFeedsScore[TD_ROW_MA_HTF]   = true;
+   rowFeedsScore[TD_ROW_ADX]      = true;
+   rowFeedsScore[TD_ROW_ICHIMOKU] = true;
+   rowFeedsScore[TD_ROW_PRICEACTION] = true;
+   rowFeedsScore[TD_ROW_MACD]     = true;
+   rowFeedsScore[TD_ROW_RSI]      = true;
+   rowFeedsScore[TD_ROW_CCI]      = true;
+   rowFeedsScore[TD_ROW_SAR]      = true;
+   rowFeedsScore[TD_ROW_DELTA]    = true;
+   rowFeedsScore[TD_ROW_PRESSAO]  = true;
+   for(int row = 0; row < TD_ROW_COUNT; row++)
+      scoreFeeds[row] = rowFeedsScore[row] ? 1 : 0;
+   
+   ArrayResize(scoreBatch, totalSymbols);
+   ArrayResize(scoreBatchOut, totalSymbols * SCORE_OUT_STRIDE);
+   
+   ArrayResize(rowSignal, TD_ROW_COUNT * totalSymbols);
+   ArrayResize(rowSignalVersion, TD_ROW_COUNT * totalSymbols);
+   ArrayInitialize(rowSignal, 0);
+   ArrayInitialize(rowSignalVersion, 0);
+   
+   // Entradas começam na versão 1 e o Score na 0: o primeiro frame calcula todos os símbolos
+   ArrayResize(scoreInputVersion, totalSymbols);
+   ArrayResize(scoreSeenVersion, totalSymbols);
+   ArrayInitialize(scoreInputVersion, 1);
+   ArrayInitialize(scoreSeenVersion, 0);
+   scoreRecomputesFrame = 0;
+   scoreRecomputes = 0;
+   scoreSkips = 0;
+}
+
+/**
+ * @brief Publica o sinal de uma linha para um símbolo. A versão só muda se o sinal mudar.
+ * @param row    Linha da tabela.
+ * @param i      Índice do símbolo em symbolArray.
+ * @param signal +1 alta, -1 baixa, 0 neutro.
+ */
+void SetRowSignal(ENUM_TD_ROW row, int i, int signal)
+{
+   int slot = CellSlot(row, i);
+   if(rowSignal[slot] == signal) return;
+   rowSignal[slot] = signal;
+   rowSignalVersion[slot]++;
+   if(rowFeedsScore[row])
+      scoreInputVersion[i]++;
+}
+
+/**
+ * @brief Recalcula Score, Pontuação, Status e Ações apenas dos símbolos cujas entradas mudaram.
+ */
+void UpdateScores()
+{
+   // 1. Reúne os símbolos cujas entradas mudaram
+   int count = 0;
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      if(scoreSeenVersion[i] == scoreInputVersion[i])
+      {
+         scoreSkips++;
+         continue;
+      }
+      scoreSeenVersion[i] = scoreInputVersion[i];
+      scoreBatch[count++] = i;
+   }
+   scoreRecomputesFrame = count;
+   scoreRecomputes += count;
+   if(count == 0) return;
+   
+   // 2. Calcula o lote inteiro de uma vez
+   ComputeScoresBatch(rowSignal, scoreFeeds, TD_ROW_COUNT, scoreBatch, count, scoreBatchOut);
+   
+   // 3. Aplica os resultados às células
+   for(int k = 0; k < count; k++)
+   {
+      int i = scoreBatch[k];
+      double score = scoreBatchOut[k * SCORE_OUT_STRIDE];
+      int bull = (int)scoreBatchOut[k * SCORE_OUT_STRIDE + 1];
+      int neutral = (int)scoreBatchOut[k * SCORE_OUT_STRIDE + 2];
+      int bear = (int)scoreBatchOut[k * SCORE_OUT_STRIDE + 3];
+      int points = (int)MathRound(score);
+      
+      string scoreText = (score > 50) ? "🟢 " + IntegerToString(points) : "🔴 " + IntegerToString(points);
+      SetCellValue(TD_ROW_SCORE, i, scoreText, (score > 50) ? clrBuyGreen : clrSellRed);
+      
+      // Pontuação: entradas em alta - neutras - em baixa
+      SetCellValue(TD_ROW_PONT, i, StringFormat("%d-%d-%d", bull, neutral, bear), clrNormalText);
+      
+      // Status: ✅ quando as entradas concordam em uma direção, ⚠️ quando estão divididas
+      int n = bull + neutral + bear;
+      SetCellValue(TD_ROW_STATUS, i, (2 * MathAbs(bull - bear) >= n) ? "✅" : "⚠️", clrNormalText);
+      
+      // Ações: a luz indica o lado sugerido pelo Score (🟢 compra, 🔴 venda, ⚪ aguardar)
+      string light = (score >= 65.0) ? "🟢" : (score <= 35.0) ? "🔴" : "⚪";
+      SetCellValue(TD_ROW_ACOES, i, "▲ ▼ " + light, clrNormalText);
+   }
+}
+
+/**
+ * @brief Cálculo do Score em lote sobre buffers planos (um símbolo após o outro, sem estado global).
+ * @param signals Sinais de todas as (linha, símbolo); as linhas de um símbolo são contíguas.
+ * @param feeds   1 para as linhas que entram no Score.
+ * @param rows    Linhas por símbolo.
+ * @param symbols Símbolos a calcular.
+ * @param count   Quantidade de símbolos em `symbols`.
+ * @param out     Recebe [score, alta, neutras, baixa] de cada símbolo, na ordem de `symbols`.
+ */
+void ComputeScoresBatch(const int &signals[], const int &feeds[], int rows, const int &symbols[], int count, double &out[])
+{
+   for(int k = 0; k < count; k++)
+   {
+      int bull = 0, neutral = 0, bear = 0;
+      int base = symbols[k] * rows;
+      for(int row = 0; row < rows; row++)
+      {
+         if(feeds[row] == 0) continue;
+         int sig = signals[base + row];
+         if(sig > 0) bull++;
+         else if(sig < 0) bear++;
+         else neutral++;
+      }
+      int n = bull + neutral + bear;
+      out[k * SCORE_OUT_STRIDE]     = (n > 0) ? 50.0 + 50.0 * (bull - bear) / n : 50.0;
+      out[k * SCORE_OUT_STRIDE + 1] = bull;
+      out[k * SCORE_OUT_STRIDE + 2] = neutral;
+      out[k * SCORE_OUT_STRIDE + 3] = bear;
+   }
+}
+
+/**
+ * @brief Registra no diário, periodicamente, quantos símbolos tiveram o Score recalculado.
+ */
+void ScoreReport()
+{
+   static ulong reportAt = 0;
+   ulong now = GetMicrosecondCount();
+   if(reportAt == 0) { reportAt = now; return; }
+   double elapsed = (now - reportAt) / 1000000.0;
+   if(elapsed < STATS_REPORT_SEC) return;
+   
+   LOG_INFO(StringFormat("[0800] Score: %I64u recálculos e %I64u símbolos sem mudança em %.0f s",
+                         scoreRecomputes, scoreSkips, elapsed));
+   scoreRecomputes = 0;
+   scoreSkips = 0;
+   reportAt = now;
+}
+
+//+------------------------------------------------------------------+
+//| Latência por Etapa (Aba 2)                                       |
+//| As medições (PROBE_*) alimentam histogramas de faixas fixas, por |
+//| etapa e por símbolo; registrar custa um incremento. p50/p99 são  |
+//| lidos dos histogramas apenas quando a Aba 2 está visível, uma    |
+//| vez por LATENCY_REFRESH_MS.                                      |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Zera os histogramas de todas as etapas e símbolos.
+ */
+void LatencyReset()
+{
+   for(int st = 0; st < TD_STAGE_COUNT; st++)
+      LatencyClear(stageLatency[st]);
+   ArrayResize(symbolLatency, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+      LatencyClear(symbolLatency[i]);
+}
+
+void LatencyClear(LatencyHistogram &h)
+{
+   ArrayInitialize(h.buckets, 0);
+   h.count = 0;
+   h.max = 0;
+}
+
+/**
+ * @brief Registra uma duração: a faixa é o número de bits da duração em µs.
+ */
+void LatencyRecord(LatencyHistogram &h, ulong us)
+{
+   int b = 0;
+   for(ulong v = us; v > 0 && b < LATENCY_BUCKETS - 1; v >>= 1)
+      b++;
+   h.buckets[b]++;
+   h.count++;
+   if(us > h.max) h.max = us;
+}
+
+/**
+ * @brief Percentil aproximado de um histograma (limite superior da faixa, no máximo o maior valor).
+ * @param q Fração de 0 a 1 (0.5 = mediana).
+ */
+ulong LatencyPercentile(const LatencyHistogram &h, double q)
+{
+   long target = (long)MathCeil(q * h.count), seen = 0;
+   for(int b = 0; b < LATENCY_BUCKETS; b++)
+   {
+      seen += h.buckets[b];
+      if(seen >= target && seen > 0)
+      {
+         ulong upper = (b == 0) ? 0 : ((ulong)1 << b) - 1;
+         return MathMin(upper, h.max);
+      }
+   }
+   return h.max;
+}
+
+/**
+ * @brief Duração formatada (µs abaixo de 10 ms, ms acima).
+ */
+string LatencyFormat(ulong us)
+{
+   return (us < 10000) ? IntegerToString((long)us) + " µs" : DoubleToString(us / 1000.0, 1) + " ms";
+}
+
+int LatencyLabelCount()
+{
+   return LATENCY_GRID_CELLS + LATENCY_INFO_LINES;
+}
+
+/**
+ * @brief Texto atual de um rótulo da Aba 2.
+ * @param k Rótulo: primeiro a tabela (linha a linha, LATENCY_COLUMNS por linha), depois as linhas de contadores.
+ */
+string LatencyLabelText(int k)
+{
+   if(k < LATENCY_COLUMNS)
+   {
+      string header[LATENCY_COLUMNS] = {"Etapa", "p50", "p99", "máx", "amostras"};
+      return header[k];
+   }
+   if(k < LATENCY_GRID_CELLS)
+   {
+      int st = k / LATENCY_COLUMNS - 1;
+      switch(k % LATENCY_COLUMNS)
+      {
+         case 0:
+         {
+            string names[TD_STAGE_COUNT] = {"Ticks", "Cálculo", "Diff", "Desenho", "Frame"};
+            return names[st];
+         }
+         case 1:  return (stageLatency[st].count > 0) ? LatencyFormat(LatencyPercentile(stageLatency[st], 0.50)) : "-";
+         case 2:  return (stageLatency[st].count > 0) ? LatencyFormat(LatencyPercentile(stageLatency[st], 0.99)) : "-";
+         case 3:  return (stageLatency[st].count > 0) ? LatencyFormat(stageLatency[st].max) : "-";
+         default: return IntegerToString(stageLatency[st].count);
+      }
+   }
+   
+   switch(k - LATENCY_GRID_CELLS)
+   {
+      case 0:
+      {
+#ifdef TD_NO_LATENCY
+         return "Medições desativadas (TD_NO_LATENCY)";
+#else
+         // Símbolo com o maior p99 do recálculo completo
+         int slowest = -1;
+         ulong worst = 0;
+         for(int i = 0; i < ArraySize(symbolLatency); i++)
+         {
+            if(symbolLatency[i].count == 0) continue;
+            ulong p99 = LatencyPercentile(symbolLatency[i], 0.99);
+            if(slowest < 0 || p99 > worst) { slowest = i; worst = p99; }
+         }
+         if(slowest < 0) return "Símbolo mais lento: -";
+         return "Símbolo mais lento: " + symbolArray[slowest] + "  p99 " + LatencyFormat(worst) +
+                "  máx " + LatencyFormat(symbolLatency[slowest].max);
+#endif
+      }
+      case 1:  return "Ticks coalescidos: " + IntegerToString((long)ticksCoalesced);
+      case 2:  return "Recálculos adiados (orçamento do frame): " + IntegerToString((long)symbolsDeferred);
+      default: return "Leituras de ticks truncadas: " + IntegerToString((long)tickReadsTruncated);
+   }
+}
+
+/**
+ * @brief Atualiza os rótulos da Aba 2, se ela está visível, no máximo uma vez por
+ *        LATENCY_REFRESH_MS. Só os rótulos cujo texto mudou são enviados ao terminal.
+ * @param force Atualiza mesmo antes do intervalo (ao abrir a aba).
+ */
+void UpdateLatencyTab(bool force = false)
+{
+   if(activeTab != 2 || panelMinimized || ArraySize(latencyTexts) == 0) return;
+   ulong now = GetMicrosecondCount();
+   if(!force && now - latencyRefreshAt < (ulong)LATENCY_REFRESH_MS * 1000) return;
+   latencyRefreshAt = now;
+   
+   int pushed = 0;
+   for(int k = 0; k < ArraySize(latencyTexts); k++)
+   {
+      string text = LatencyLabelText(k);
+      if(text == latencyTexts[k]) continue;
+      PanelSetString("TD_Lat_" + IntegerToString(k), OBJPROP_TEXT, text);
+      latencyTexts[k] = text;
+      pushed++;
+   }
+   if(pushed > 0) PanelRedraw();
+}
+
+//+------------------------------------------------------------------+
+//| Pool de Handles de Indicadores                                   |
+//| Um handle por (símbolo, tempo gráfico, indicador, parâmetros),   |
+//| compartilhado entre as linhas. Os handles são criados aos poucos |
+//| (HANDLE_CREATES_PER_FRAME), só são lidos depois que              |
+//| BarsCalculated indica que estão prontos e só os buffers usados   |
+//| pelas linhas são copiados, uma vez por barra nova. Um handle que |
+//| falha é tentado de novo após INDICATOR_RETRY_SEC; esgotadas as   |
+//| tentativas, a linha mostra "erro". Liberados em OnDeinit.        |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Adiciona um parâmetro inteiro a uma lista de parâmetros de indicador.
+ */
+void AddParam(MqlParam &params[], long value)
+{
+   int n = ArraySize(params);
+   ArrayResize(params, n + 1);
+   params[n].type = TYPE_INT;
+   params[n].integer_value = value;
+}
+
+/**
+ * @brief Adiciona um parâmetro real a uma lista de parâmetros de indicador.
+ */
+void AddParam(MqlParam &params[], double value)
+{
+   int n = ArraySize(params);
+   ArrayResize(params, n + 1);
+   params[n].type = TYPE_DOUBLE;
+   params[n].double_value = value;
+}
+
+/**
+ * @brief Retorna o handle do pool para o indicador pedido, registrando-o se for novo.
+ *        O handle não é criado aqui; IndicatorPoolService o cria em um frame seguinte.
+ * @param symbol  Símbolo.
+ * @param tf      Tempo gráfico.
+ * @param type    Tipo do indicador (IND_ADX, IND_RSI, ...).
+ * @param params  Parâmetros do indicador.
+ * @param mask    Buffers que serão lidos (bit b = buffer b); pedidos repetidos somam os buffers.
+ * @return Índice em indicatorPool.
+ */
+int IndicatorPoolGet(string symbol, ENUM_TIMEFRAMES tf, ENUM_INDICATOR type, const MqlParam &params[], int mask)
+{
+   if(tf == PERIOD_CURRENT) tf = Period();
+   string key = symbol + "|" + IntegerToString((int)tf) + "|" + IntegerToString((int)type);
+   for(int k = 0; k < ArraySize(params); k++)
+      key += "|" + ((params[k].type == TYPE_DOUBLE) ? DoubleToString(params[k].double_value, 8) : IntegerToString(params[k].integer_value));
+   
+   mask &= (1 << INDICATOR_MAX_BUFFERS) - 1;
+   int slot;
+   if(indicatorPoolIndex.TryGetValue(key, slot))
+   {
+      indicatorPool[slot].bufferMask |= mask;
+      return slot;
+   }
+   
+   slot = ArraySize(indicatorPool);
+   ArrayResize(indicatorPool, slot + 1, 64);
+   indicatorPool[slot].symbol = symbol;
+   indicatorPool[slot].tf = tf;
+   indicatorPool[slot].type = type;
+   ArrayResize(indicatorPool[slot].params, ArraySize(params));
+   for(int k = 0; k < ArraySize(params); k++)
+      indicatorPool[slot].params[k] = params[k];
+   indicatorPool[slot].bufferMask = mask;
+   indicatorPool[slot].handle = INVALID_HANDLE;
+   indicatorPool[slot].failed = false;
+   indicatorPool[slot].attempts = 0;
+   indicatorPool[slot].retryAt = 0;
+   indicatorPool[slot].cacheSlot = BarCacheGet(symbol, tf, 3);
+   indicatorPool[slot].seenClosed = -1;
+   indicatorPool[slot].seenReload = -1;
+   indicatorPool[slot].hasValues = false;
+   ArrayResize(indicatorPool[slot].values, 2 * INDICATOR_MAX_BUFFERS);
+   ArrayInitialize(indicatorPool[slot].values, 0.0);
+   indicatorPoolIndex.Add(key, slot);
+   return slot;
+}
+
+/**
+ * @brief Registra no pool os indicadores de todos os símbolos.
+ */
+void ResetIndicatorPool()
+{
+   ReleaseIndicatorPool();
+   ArrayResize(symbolIndicators, totalSymbols);
+   ArrayResize(warmups, totalSymbols);
+   
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      string symbol = symbolArray[i];
+      MqlParam adx[], ichimoku[], macd[], rsi[], cci[], sar[];
+      AddParam(adx, (long)14);
+      AddParam(ichimoku, (long)9);
+      AddParam(ichimoku, (long)26);
+      AddParam(ichimoku, (long)52);
+      AddParam(macd, (long)12);
+      AddParam(macd, (long)26);
+      AddParam(macd, (long)9);
+      AddParam(macd, (long)PRICE_CLOSE);
+      AddParam(rsi, (long)14);
+      AddParam(rsi, (long)PRICE_CLOSE);
+      AddParam(cci, (long)14);
+      AddParam(cci, (long)PRICE_TYPICAL);
+      AddParam(sar, 0.02);
+      AddParam(sar, 0.2);
+      
+      // Buffers lidos: ADX principal, +DI e -DI; Ichimoku só Senkou Span A e B; MACD principal e sinal
+      symbolIndicators[i].adx      = IndicatorPoolGet(symbol, MATimeframe, IND_ADX, adx, 0x7);
+      symbolIndicators[i].ichimoku = IndicatorPoolGet(symbol, MATimeframe, IND_ICHIMOKU, ichimoku, 0xC);
+      symbolIndicators[i].macd     = IndicatorPoolGet(symbol, MATimeframe, IND_MACD, macd, 0x3);
+      symbolIndicators[i].rsi      = IndicatorPoolGet(symbol, MATimeframe, IND_RSI, rsi, 0x1);
+      symbolIndicators[i].cci      = IndicatorPoolGet(symbol, MATimeframe, IND_CCI, cci, 0x1);
+      symbolIndicators[i].sar      = IndicatorPoolGet(symbol, MATimeframe, IND_SAR, sar, 0x1);
+      
+      warmups[i].cacheSlot = BarCacheGet(symbol, MATimeframe, WARMUP_BARS + 1);
+      warmups[i].seenClosed = -1;
+      warmups[i].seenReload = -1;
+      warmups[i].valid = false;
+   }
+}
+
+/**
+ * @brief Libera todos os handles criados e esvazia o pool.
+ */
+void ReleaseIndicatorPool()
+{
+   for(int k = 0; k < ArraySize(indicatorPool); k++)
+      if(indicatorPool[k].handle != INVALID_HANDLE)
+         IndicatorRelease(indicatorPool[k].handle);
+   ArrayFree(indicatorPool);
+   indicatorPoolIndex.Clear();
+   indicatorPoolPending = 0;
+   indicatorPoolFailed = 0;
+}
+
+/**
+ * @brief Tenta criar o handle de um indicador do pool; uma falha agenda nova tentativa.
+ * @param k Índice em indicatorPool.
+ */
+void IndicatorPoolCreate(int k)
+{
+   indicatorPool[k].attempts++;
+   indicatorPool[k].handle = IndicatorCreate(indicatorPool[k].symbol, indicatorPool[k].tf, indicatorPool[k].type,
+                                             ArraySize(indicatorPool[k].params), indicatorPool[k].params);
+   bool wasFailed = indicatorPool[k].failed;
+   indicatorPool[k].failed = (indicatorPool[k].handle == INVALID_HANDLE);
+   if(indicatorPool[k].failed != wasFailed)
+      indicatorPoolFailed += indicatorPool[k].failed ? 1 : -1;
+   if(!indicatorPool[k].failed) return;
+   
+   indicatorPool[k].retryAt = GetMicrosecondCount() + (ulong)INDICATOR_RETRY_SEC * 1000000;
+   LOG_WARN("[0700] Falha ao criar indicador " + EnumToString(indicatorPool[k].type) + " em " + indicatorPool[k].symbol +
+            " (erro " + IntegerToString(GetLastError()) + ", tentativa " + IntegerToString(indicatorPool[k].attempts) +
+            " de " + IntegerToString(INDICATOR_MAX_RETRIES) + ")");
+}
+
+/**
+ * @brief Cria, a cada frame, no máximo HANDLE_CREATES_PER_FRAME handles: primeiro os ainda
+ *        pendentes, em ordem, e depois os que falharam e já podem ser tentados de novo.
+ */
+void IndicatorPoolService()
+{
+   // Símbolos reproduzidos ou sintéticos não existem no terminal: não há indicadores a criar
+   if(tickSource != TICK_SOURCE_LIVE) return;
+   
+   int created = 0;
+   while(indicatorPoolPending < ArraySize(indicatorPool) && created < HANDLE_CREATES_PER_FRAME)
+   {
+      IndicatorPoolCreate(indicatorPoolPending++);
+      created++;
+   }
+   if(indicatorPoolFailed == 0 || created >= HANDLE_CREATES_PER_FRAME) return;
+   
+   ulong now = GetMicrosecondCount();
+   for(int k = 0; k < indicatorPoolPending && created < HANDLE_CREATES_PER_FRAME; k++)
+   {
+      if(!indicatorPool[k].failed || indicatorPool[k].attempts >= INDICATOR_MAX_RETRIES || now < indicatorPool[k].retryAt)
+         continue;
+      IndicatorPoolCreate(k);
+      created++;
+   }
+}
+
+/**
+ * @brief Garante que os valores das barras fechadas do indicador estão atualizados.
+ *        Não bloqueia: se o handle ainda não existe ou não terminou de calcular, retorna false.
+ * @param slot Índice em indicatorPool.
+ * @return true se values[] contém valores válidos.
+ */
+bool IndicatorPoolRead(int slot)
+{
+   int h = indicatorPool[slot].handle;
+   if(h == INVALID_HANDLE) return false;
+   if(BarsCalculated(h) <= 0) return indicatorPool[slot].hasValues;
+   
+   // Só copia os buffers quando há barra nova (ou na primeira leitura)
+   int cs = indicatorPool[slot].cacheSlot;
+   if(!BarCacheSync(cs)) return indicatorPool[slot].hasValues;
+   if(indicatorPool[slot].hasValues &&
+      indicatorPool[slot].seenClosed == barCache[cs].closedCount &&
+      indicatorPool[slot].seenReload == barCache[cs].reloadVersion)
+      return true;
+   
+   // CopyBuffer lê um buffer por chamada: só os buffers usados pelas linhas são copiados, cada um
+   // com as duas últimas barras fechadas (a mais antiga primeiro), no mesmo buffer reaproveitado
+   int mask = indicatorPool[slot].bufferMask;
+   for(int b = 0; b < INDICATOR_MAX_BUFFERS; b++)
+   {
+      if((mask & (1 << b)) == 0) continue;
+      if(CopyBuffer(h, b, 1, 2, indicatorReadBuffer) < 2) return indicatorPool[slot].hasValues; // Tenta de novo no próximo frame
+      indicatorPool[slot].values[b * 2]     = indicatorReadBuffer[1];
+      indicatorPool[slot].values[b * 2 + 1] = indicatorReadBuffer[0];
+   }
+   indicatorPool[slot].seenClosed = barCache[cs].closedCount;
+   indicatorPool[slot].seenReload = barCache[cs].reloadVersion;
+   indicatorPool[slot].hasValues = true;
+   return true;
+}
+
+/**
+ * @brief Valor lido de um indicador do pool.
+ * @param slot   Índice em indicatorPool.
+ * @param buffer Número do buffer.
+ * @param shift  Barra fechada: 1 = última, 2 = penúltima.
+ */
+double IndicatorValue(int slot, int buffer, int shift = 1)
+{
+   return indicatorPool[slot].values[buffer * 2 + (shift - 1)];
+}
+
+/**
+ * @brief Marca uma linha de indicador como "aguardando cálculo" ou, se a criação do handle
+ *        falhou, como "erro" (com as tentativas esgotadas, permanece assim).
+ * @param slot Índice do indicador da linha em indicatorPool.
+ */
+void SetIndicatorPending(ENUM_TD_ROW row, int i, int slot)
+{
+   if(indicatorPool[slot].failed)
+      SetCellValue(row, i, "erro", clrWarning);
+   else
+      SetCellValue(row, i, "...", clrNeutralText);
+   SetRowSignal(row, i, 0);
+}
+
+/**
+ * @brief Atualiza as linhas de indicadores (ADX, Ichimoku, MACD, RSI, CCI, SAR) de um símbolo.
+ * @param i Índice do símbolo em symbolArray.
+ */
+void UpdateIndicatorRows(int i)
+{
+   double close = mainSeries[i].close;
+   
+   // ADX: força da tendência; a cor indica quem domina (+DI ou -DI)
+   int h = symbolIndicators[i].adx;
+   if(IndicatorPoolRead(h))
+   {
+      int dir = (IndicatorValue(h, 1) >= IndicatorValue(h, 2)) ? 1 : -1;
+      SetMetric(TD_ROW_ADX, i, IndicatorValue(h, 0), (dir > 0) ? clrBuyGreen : clrSellRed);
+      // Só conta para o Score quando há tendência (ADX acima de 20)
+      SetRowSignal(TD_ROW_ADX, i, (IndicatorValue(h, 0) > 20.0) ? dir : 0);
+   }
+   else SetIndicatorPending(TD_ROW_ADX, i, h);
+   
+   // Ichimoku: preço acima da nuvem = Alta, abaixo = Baixa, dentro = Lateral
+   h = symbolIndicators[i].ichimoku;
+   if(IndicatorPoolRead(h))
+   {
+      double spanA = IndicatorValue(h, 2), spanB = IndicatorValue(h, 3);
+      string state = (close > MathMax(spanA, spanB)) ? "Alta" : (close < MathMin(spanA, spanB)) ? "Baixa" : "Lateral";
+      SetCellValue(TD_ROW_ICHIMOKU, i, state, TrendColor(state));
+      SetRowSignal(TD_ROW_ICHIMOKU, i, TrendSignal(state));
+   }
+   else SetIndicatorPending(TD_ROW_ICHIMOKU, i, h);
+   
+   // MACD, RSI e CCI: enquanto o handle não tem valores, usa o aquecimento calculado sobre o cache
+   // MACD: linha principal acima da linha de sinal = Alta
+   h = symbolIndicators[i].macd;
+   bool live = IndicatorPoolRead(h);
+   if(live || WarmupRead(i))
+   {
+      double diff = live ? IndicatorValue(h, 0) - IndicatorValue(h, 1) : warmups[i].macd - warmups[i].macdSignal;
+      string state = (diff > 0.0) ? "Alta" : (diff < 0.0) ? "Baixa" : "Lateral";
+      SetCellValue(TD_ROW_MACD, i, state, TrendColor(state));
+      SetRowSignal(TD_ROW_MACD, i, TrendSignal(state));
+   }
+   else SetIndicatorPending(TD_ROW_MACD, i, h);
+   
+   // RSI e CCI: valor numérico, verde acima do ponto médio
+   h = symbolIndicators[i].rsi;
+   live = IndicatorPoolRead(h);
+   if(live || WarmupRead(i))
+   {
+      double rsi = live ? IndicatorValue(h, 0) : warmups[i].rsi;
+      SetMetric(TD_ROW_RSI, i, rsi, (rsi >= 50.0) ? clrBuyGreen : clrSellRed);
+      SetRowSignal(TD_ROW_RSI, i, (rsi > 55.0) ? 1 : (rsi < 45.0) ? -1 : 0);
+   }
+   else SetIndicatorPending(TD_ROW_RSI, i, h);
+   
+   h = symbolIndicators[i].cci;
+   live = IndicatorPoolRead(h);
+   if(live || WarmupRead(i))
+   {
+      double cci = live ? IndicatorValue(h, 0) : warmups[i].cci;
+      SetMetric(TD_ROW_CCI, i, cci, (cci >= 0.0) ? clrBuyGreen : clrSellRed);
+      SetRowSignal(TD_ROW_CCI, i, (cci > 100.0) ? 1 : (cci < -100.0) ? -1 : 0);
+   }
+   else SetIndicatorPending(TD_ROW_CCI, i, h);
+   
+   // SAR: nível do stop; verde com o preço acima (SAR abaixo do preço)
+   h = symbolIndicators[i].sar;
+   if(IndicatorPoolRead(h))
+   {
+      double sar = IndicatorValue(h, 0);
+      SetMetric(TD_ROW_SAR, i, sar, (close >= sar) ? clrBuyGreen : clrSellRed);
+      SetRowSignal(TD_ROW_SAR, i, (close > sar) ? 1 : -1);
+   }
+   else SetIndicatorPending(TD_ROW_SAR, i, h);
+}
+
+/**
+ * @brief Sinal (+1, -1, 0) de um estado de tendência em texto.
+ */
+int TrendSignal(string state)
+{
+   return (state == "Alta") ? 1 : (state == "Baixa") ? -1 : 0;
+}
+
+/**
+ * @brief Cor padrão para os estados de tendência em texto.
+ */
+color TrendColor(string state)
+{
+   return (state == "Alta") ? clrBuyGreen : (state == "Baixa") ? clrSellRed : clrNeutralText;
+}
+
+//+------------------------------------------------------------------+
+//| Aquecimento dos Indicadores                                      |
+//| Enquanto o terminal cria e calcula os handles do pool, RSI, CCI  |
+//| e MACD são calculados de uma vez sobre as barras fechadas do     |
+//| cache, em arrays contíguos. As operações elemento a elemento     |
+//| usam vector (vetorizado pelo terminal); as recorrências (Wilder, |
+//| EMA) são sequenciais nas duas versões. TD_SCALAR_KERNELS força   |
+//| os laços escalares, que são a referência do benchmark.           |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief RSI de Wilder da última barra de uma série.
+ * @param close      Fechamentos, do mais antigo para o mais recente.
+ * @param n          Quantidade de fechamentos.
+ * @param period     Período do RSI.
+ * @param vectorized Se calcula as variações com vector (false = laço escalar).
+ * @return RSI da última barra ou EMPTY_VALUE se a série é curta demais.
+ */
+double KernelRSI(const double &close[], int n, int period, bool vectorized)
+{
+   if(n <= period) return EMPTY_VALUE;
+   
+   // Altas e baixas de cada barra em relação à anterior (a primeira posição é zero)
+   vector up, down;
+   if(vectorized)
+   {
+      double prev[];
+      ArrayResize(prev, n);
+      prev[0] = close[0];
+      ArrayCopy(prev, close, 1, 0, n - 1);
+      vector c, p;
+      c.Assign(close);
+      p.Assign(prev);
+      up = c - p;
+      down = p - c;
+      up.Clip(0.0, DBL_MAX);
+      down.Clip(0.0, DBL_MAX);
+   }
+   else
+   {
+      up.Init(n);
+      down.Init(n);
+      up[0] = 0.0;
+      down[0] = 0.0;
+      for(int k = 1; k < n; k++)
+      {
+         double d = close[k] - close[k - 1];
+         up[k] = (d > 0.0) ? d : 0.0;
+         down[k] = (d < 0.0) ? -d : 0.0;
+      }
+   }
+   
+   // Semente: média simples das primeiras `period` variações; depois, suavização de Wilder
+   double avgUp = 0.0, avgDown = 0.0;
+   for(int k = 1; k <= period; k++)
+   {
+      avgUp += up[k];
+      avgDown += down[k];
+   }
+   avgUp /= period;
+   avgDown /= period;
+   for(int k = period + 1; k < n; k++)
+   {
+      avgUp = (avgUp * (period - 1) + up[k]) / period;
+      avgDown = (avgDown * (period - 1) + down[k]) / period;
+   }
+   return (avgDown == 0.0) ? 100.0 : 100.0 - 100.0 / (1.0 + avgUp / avgDown);
+}
+
+/**
+ * @brief CCI da última barra de uma série (preço típico).
+ * @param high, low, close Máximas, mínimas e fechamentos, do mais antigo para o mais recente.
+ * @param n          Quantidade de barras.
+ * @param period     Período do CCI.
+ * @param vectorized Se calcula a média e o desvio com vector (false = laço escalar).
+ * @return CCI da última barra ou EMPTY_VALUE se a série é curta demais.
+ */
+double KernelCCI(const double &high[], const double &low[], const double &close[], int n, int period, bool vectorized)
+{
+   if(n < period) return EMPTY_VALUE;
+   int start = n - period;
+   double mean, deviation, last;
+   
+   if(vectorized)
+   {
+      double h[], l[], c[];
+      ArrayCopy(h, high, 0, start, period);
+      ArrayCopy(l, low, 0, start, period);
+      ArrayCopy(c, close, 0, start, period);
+      vector vh, vl, vc;
+      vh.Assign(h);
+      vl.Assign(l);
+      vc.Assign(c);
+      vector tp = (vh + vl + vc) / 3.0;
+      mean = tp.Mean();
+      deviation = MathAbs(tp - mean).Mean();
+      last = tp[period - 1];
+   }
+   else
+   {
+      double tp[];
+      ArrayResize(tp, period);
+      mean = 0.0;
+      for(int k = 0; k < period; k++)
+      {
+         tp[k] = (high[start + k] + low[start + k] + close[start + k]) / 3.0;
+         mean += tp[k];
+      }
+      mean /= period;
+      deviation = 0.0;
+      for(int k = 0; k < period; k++)
+         deviation += MathAbs(tp[k] - mean);
+      deviation /= period;
+      last = tp[period - 1];
+   }
+   return (deviation == 0.0) ? 0.0 : (last - mean) / (0.015 * deviation);
+}
+
+/**
+ * @brief MACD da última barra de uma série, como o iMACD do terminal: diferença entre as
+ *        EMAs rápida e lenta, com a linha de sinal como média simples dessa diferença.
+ * @param close      Fechamentos, do mais antigo para o mais recente.
+ * @param n          Quantidade de fechamentos.
+ * @param fast, slow, signal Períodos do MACD.
+ * @param vectorized Se calcula a diferença e o sinal com vector (false = laço escalar).
+ * @param main       Recebe a linha principal.
+ * @param sig        Recebe a linha de sinal.
+ * @return false se a série é curta demais.
+ */
+bool KernelMACD(const double &close[], int n, int fast, int slow, int signal, bool vectorized, double &main, double &sig)
+{
+   if(n < slow + signal) return false;
+   
+   // As EMAs são recorrências: sequenciais nas duas versões (iniciadas no primeiro fechamento)
+   double emaFast[], emaSlow[];
+   ArrayResize(emaFast, n);
+   ArrayResize(emaSlow, n);
+   double kf = 2.0 / (fast + 1), ks = 2.0 / (slow + 1);
+   emaFast[0] = close[0];
+   emaSlow[0] = close[0];
+   for(int k = 1; k < n; k++)
+   {
+      emaFast[k] = emaFast[k - 1] + kf * (close[k] - emaFast[k - 1]);
+      emaSlow[k] = emaSlow[k - 1] + ks * (close[k] - emaSlow[k - 1]);
+   }
+   
+   if(vectorized)
+   {
+      vector vf, vs;
+      vf.Assign(emaFast);
+      vs.Assign(emaSlow);
+      vector line = vf - vs;
+      main = line[n - 1];
+      double tail[];
+      ArrayResize(tail, signal);
+      for(int k = 0; k < signal; k++)
+         tail[k] = line[n - signal + k];
+      vector vt;
+      vt.Assign(tail);
+      sig = vt.Mean();
+   }
+   else
+   {
+      main = emaFast[n - 1] - emaSlow[n - 1];
+      sig = 0.0;
+      for(int k = n - signal; k < n; k++)
+         sig += emaFast[k] - emaSlow[k];
+      sig /= signal;
+   }
+   return true;
+}
+
+/**
+ * @brief Calcula RSI, CCI e MACD de uma série de barras com os kernels de aquecimento
+ *        (mesmos parâmetros dos handles criados em ResetIndicatorPool).
+ * @return false se a série é curta demais para algum dos três.
+ */
+bool WarmupCompute(const double &high[], const double &low[], const double &close[], int n, bool vectorized, IndicatorWarmup &w)
+{
+   w.rsi = KernelRSI(close, n, 14, vectorized);
+   w.cci = KernelCCI(high, low, close, n, 14, vectorized);
+   bool ok = KernelMACD(close, n, 12, 26, 9, vectorized, w.macd, w.macdSignal);
+   return ok && w.rsi != EMPTY_VALUE && w.cci != EMPTY_VALUE;
+}
+
+/**
+ * @brief Garante que o aquecimento do símbolo está calculado para a última barra fechada.
+ *        Recalcula, em uma passada, só quando o cache tem barra nova ou foi recarregado.
+ * @param i Índice do símbolo em symbolArray.
+ * @return true se warmups[i] contém valores válidos.
+ */
+bool WarmupRead(int i)
+{
+   int cs = warmups[i].cacheSlot;
+   if(!BarCacheSync(cs)) return warmups[i].valid;
+   if(warmups[i].valid &&
+      warmups[i].seenClosed == barCache[cs].closedCount &&
+      warmups[i].seenReload == barCache[cs].reloadVersion)
+      return true;
+   
+   // Só as barras fechadas, da mais antiga para a mais recente
+   int n = barCache[cs].count - 1;
+   if(n <= 0) return false;
+   double high[], low[], close[];
+   ArrayResize(high, n);
+   ArrayResize(low, n);
+   ArrayResize(close, n);
+   MqlRates bar;
+   for(int k = 0; k < n; k++)
+   {
+      BarCacheBar(cs, n - k, bar);
+      high[k] = bar.high;
+      low[k] = bar.low;
+      close[k] = bar.close;
+   }
+   
+   warmups[i].valid = WarmupCompute(high, low, close, n, KERNEL_VECTORIZED, warmups[i]);
+   warmups[i].seenClosed = barCache[cs].closedCount;
+   warmups[i].seenReload = barCache[cs].reloadVersion;
+   return warmups[i].valid;
+}
+
+/**
+ * @brief Mede os kernels de aquecimento nas duas versões (vector e escalar) sobre uma série
+ *        sintética e registra os tempos e a maior diferença relativa entre elas. Cada valor
+ *        (RSI, CCI, MACD e sinal) fora da tolerância conta como divergência na tabela de
+ *        verificações do benchmark, que traz o tempo por série da versão vector.
+ * @param file    Arquivo CSV do benchmark.
+ * @param symbols Quantidade de séries calculadas em cada versão.
+ * @return Quantidade de valores divergentes.
+ */
+int WarmupBenchmark(int file, int symbols)
+{
+   double high[], low[], close[];
+   ArrayResize(high, WARMUP_BARS);
+   ArrayResize(low, WARMUP_BARS);
+   ArrayResize(close, WARMUP_BARS);
+   MathSrand(SYNTH_SEED);
+   double price = 100.0;
+   for(int k = 0; k < WARMUP_BARS; k++)
+   {
+      price += (MathRand() - 16383.5) / 16383.5 * 0.5;
+      close[k] = price;
+      high[k] = price + MathRand() / 32767.0 * 0.3;
+      low[k] = price - MathRand() / 32767.0 * 0.3;
+   }
+   
+   IndicatorWarmup result[2];
+   ulong elapsed[2];
+   for(int v = 0; v < 2; v++)
+   {
+      ulong start = GetMicrosecondCount();
+      for(int s = 0; s < symbols; s++)
+         WarmupCompute(high, low, close, WARMUP_BARS, v == 0, result[v]);
+      elapsed[v] = GetMicrosecondCount() - start;
+   }
+   
+   double deviation = 0.0;
+   int mismatches = 0;
+   double a[4], b[4];
+   string names[] = {"RSI", "CCI", "MACD", "sinal"};
+   a[0] = result[0].rsi;  a[1] = result[0].cci;  a[2] = result[0].macd;  a[3] = result[0].macdSignal;
+   b[0] = result[1].rsi;  b[1] = result[1].cci;  b[2] = result[1].macd;  b[3] = result[1].macdSignal;
+   for(int k = 0; k < 4; k++)
+   {
+      double d = MathAbs(a[k] - b[k]) / MathMax(MathAbs(b[k]), 1e-12);
+      deviation = MathMax(deviation, d);
+      if(d <= SELFCHECK_TOLERANCE) continue;
+      mismatches++;
+      LOG_ERROR(StringFormat("[2101] Aquecimento: %s diverge entre vector (%.10g) e escalar (%.10g), diferença relativa %.2e",
+                             names[k], a[k], b[k], d));
+   }
+   
+   LOG_INFO(StringFormat("[2100] Aquecimento de %d símbolos x %d barras: vector %I64u µs, escalar %I64u µs, maior diferença relativa %.2e",
+                         symbols, WARMUP_BARS, elapsed[0], elapsed[1], deviation));
+   BenchmarkCase(file, "warmup", symbols, (double)elapsed[0] / MathMax(symbols, 1), mismatches);
+   return mismatches;
+}
+
+//+------------------------------------------------------------------+
+//| Fluxo de Ticks por Símbolo                                       |
+//| Cada símbolo tem um cursor (time_msc + quantidade de ticks já    |
+//| vistos nesse milissegundo). A cada frame só os ticks após o      |
+//| cursor são lidos e repassados aos motores baseados em ticks.     |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Posiciona o cursor de todos os símbolos no início da sessão atual
+ *        e zera os motores alimentados pelos ticks.
+ */
+void ResetTickStreams()
+{
+   TickQueuesReset();
+   ArrayResize(tickCursors, totalSymbols);
+   ArrayResize(deltaStates, totalSymbols);
+   ArrayResize(volumeProfiles, totalSymbols);
+   ArrayResize(spreadStats, totalSymbols);
+   
+   datetime sessionStart = SessionStart(CurrentTime());
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      tickCursors[i].lastMsc = (long)sessionStart * 1000;
+      tickCursors[i].sameMscCount = 0;
+      tickCursors[i].tradeFeed = sourceTradeFeed[i];
+      DeltaReset(deltaStates[i], sessionStart);
+      ProfileReset(volumeProfiles[i], sessionStart, sourceTickSize[i]);
+      SpreadReset(spreadStats[i], sessionStart, sourceTickSize[i]);
+   }
+}
+
+/**
+ * @brief Início (00:00) do dia de um horário.
+ */
+datetime SessionStart(datetime t)
+{
+   return t - (t % 86400);
+}
+
+/**
+ * @brief Lê os ticks novos de um símbolo e os repassa, em ordem, aos motores.
+ *        Se o limite por frame for atingido, o símbolo volta à fila do agendador.
+ * @param i Índice do símbolo em symbolArray.
+ */
+void TickStreamUpdate(int i)
+{
+   MqlTick ticks[];
+   bool live = (tickSource == TICK_SOURCE_LIVE);
+   int got = live ? CopyTicks(symbolArray[i], ticks, COPY_TICKS_ALL, (ulong)tickCursors[i].lastMsc, TICKS_PER_CALL)
+                  : TickQueueTake(i, ticks);
+   if(got <= 0) return;
+   
+   // Milissegundo saturado: mais de TICKS_PER_CALL ticks com o mesmo time_msc. CopyTicks a partir do
+   // cursor devolveria sempre o mesmo lote; lê o milissegundo inteiro pelo intervalo de time_msc
+   bool saturated = live && got == TICKS_PER_CALL && ticks[got - 1].time_msc == tickCursors[i].lastMsc;
+   if(saturated)
+   {
+      got = CopyTicksRange(symbolArray[i], ticks, COPY_TICKS_ALL, (ulong)tickCursors[i].lastMsc, (ulong)tickCursors[i].lastMsc);
+      if(got <= 0) return;
+   }
+   
+   // A leitura começa no milissegundo do cursor: pula os ticks desse milissegundo que já foram processados
+   // (as filas da reprodução/gerador nunca entregam um tick duas vezes)
+   int first = 0;
+   while(live && first < got && first < tickCursors[i].sameMscCount && ticks[first].time_msc == tickCursors[i].lastMsc)
+      first++;
+   
+   for(int k = first; k < got; k++)
+   {
+      if(ticks[k].time_msc == tickCursors[i].lastMsc)
+         tickCursors[i].sameMscCount++;
+      else
+      {
+         tickCursors[i].lastMsc = ticks[k].time_msc;
+         tickCursors[i].sameMscCount = 1;
+      }
+      DeltaOnTick(deltaStates[i], tickCursors[i].tradeFeed, ticks[k]);
+      ProfileOnTick(volumeProfiles[i], tickCursors[i].tradeFeed, ticks[k]);
+      SpreadOnTick(spreadStats[i], ticks[k]);
+      if(recordHandle != INVALID_HANDLE)
+         RecordTick(i, ticks[k]);
+   }
+   
+   // Milissegundo saturado já encerrado (o terminal tem um tick mais novo): o cursor passa para
+   // o milissegundo seguinte, senão a próxima leitura recomeçaria no mesmo lote
+   if(saturated && lastTickMsc[i] > tickCursors[i].lastMsc)
+   {
+      tickCursors[i].lastMsc++;
+      tickCursors[i].sameMscCount = 0;
+      symbolPending[i] = true;
+      tickReadsTruncated++;
+   }
+   // Leitura truncada pelo limite: continua no próximo frame sem bloquear as outras colunas
+   else if(live ? (got == TICKS_PER_CALL) : (tickQueues[i].count > 0))
+   {
+      symbolPending[i] = true;
+      tickReadsTruncated++;
+   }
+}
+
+//+------------------------------------------------------------------+
+//| Origem dos Ticks: Gravação, Reprodução e Gerador Sintético       |
+//| Os ticks processados podem ser gravados em um arquivo binário    |
+//| compacto (codificação delta + varint) e reproduzidos depois, ou  |
+//| gerados sinteticamente, passando pelo mesmo caminho de cálculo e |
+//| desenho do modo ao vivo (TickStreamUpdate e o agendador).        |
+//|                                                                  |
+//| Formato: cabeçalho (magic, versão, símbolos: nome, tick size,    |
+//| dígitos, negócio) seguido de um registro por tick: símbolo,      |
+//| Δtime_msc, Δbid, Δask, Δlast (em ticks, zigzag), volume, flags.  |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Horário atual da origem dos ticks (servidor ao vivo ou relógio da reprodução/gerador).
+ */
+datetime CurrentTime()
+{
+   if(tickSource != TICK_SOURCE_LIVE && sourceClockMsc > 0)
+      return (datetime)(sourceClockMsc / 1000);
+   return TimeTradeServer();
+}
+
+/**
+ * @brief Lê do terminal o tick size, os dígitos e o tipo de feed de cada símbolo.
+ */
+void LoadSymbolProperties()
+{
+   ArrayResize(sourceTickSize, totalSymbols);
+   ArrayResize(sourceDigits, totalSymbols);
+   ArrayResize(sourceTradeFeed, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      sourceTickSize[i] = SymbolInfoDouble(symbolArray[i], SYMBOL_TRADE_TICK_SIZE);
+      if(sourceTickSize[i] <= 0.0) sourceTickSize[i] = SymbolInfoDouble(symbolArray[i], SYMBOL_POINT);
+      if(sourceTickSize[i] <= 0.0) sourceTickSize[i] = 1.0;
+      sourceDigits[i] = (int)SymbolInfoInteger(symbolArray[i], SYMBOL_DIGITS);
+      // Em bolsa o gráfico é por último negócio e os ticks trazem agressor; em FX só há cotações
+      sourceTradeFeed[i] = SymbolInfoInteger(symbolArray[i], SYMBOL_CHART_MODE) == SYMBOL_CHART_MODE_LAST;
+   }
+}
+
+/**
+ * @brief Prepara as filas de ticks vazias para todos os símbolos.
+ */
+void TickQueuesReset()
+{
+   ArrayResize(tickQueues, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      ArrayResize(tickQueues[i].ticks, 0, 1024);
+      tickQueues[i].head = 0;
+      tickQueues[i].count = 0;
+   }
+}
+
+/**
+ * @brief Coloca um tick na fila de um símbolo e o marca para recálculo.
+ */
+void TickQueuePush(int i, const MqlTick &tick)
+{
+   int n = tickQueues[i].head + tickQueues[i].count;
+   if(n >= ArraySize(tickQueues[i].ticks))
+      ArrayResize(tickQueues[i].ticks, n + 1, 1024);
+   tickQueues[i].ticks[n] = tick;
+   tickQueues[i].count++;
+   if(symbolPending[i]) ticksCoalesced++;
+   symbolPending[i] = true;
+}
+
+/**
+ * @brief Retira da fila de um símbolo até TICKS_PER_CALL ticks, na ordem de chegada.
+ * @return Número de ticks copiados para `out`.
+ */
+int TickQueueTake(int i, MqlTick &out[])
+{
+   int n = MathMin(tickQueues[i].count, TICKS_PER_CALL);
+   if(n <= 0) return 0;
+   ArrayResize(out, n);
+   for(int k = 0; k < n; k++)
+      out[k] = tickQueues[i].ticks[tickQueues[i].head + k];
+   tickQueues[i].head += n;
+   tickQueues[i].count -= n;
+   if(tickQueues[i].count == 0) tickQueues[i].head = 0; // Fila vazia: reaproveita o início do array
+   return n;
+}
+
+/**
+ * @brief Avança o relógio da reprodução/gerador em um frame e enfileira os ticks desse intervalo.
+ */
+void TickSourceAdvance()
+{
+   long step = (long)MathMax(1.0, FrameIntervalMs * ReplaySpeed);
+   if(tickSource == TICK_SOURCE_REPLAY)
+      ReplayAdvance(step);
+   else if(tickSource == TICK_SOURCE_SYNTHETIC)
+      SyntheticAdvance(step);
+}
+
+/**
+ * @brief Escreve um inteiro sem sinal em formato varint (7 bits por byte) no buffer de gravação.
+ */
+void RecordVarint(ulong v)
+{
+   if(recordLen + 10 > ArraySize(recordBuf))
+      ArrayResize(recordBuf, recordLen + TICK_FILE_CHUNK);
+   while(v >= 0x80)
+   {
+      recordBuf[recordLen++] = (uchar)((v & 0x7F) | 0x80);
+      v >>= 7;
+   }
+   recordBuf[recordLen++] = (uchar)v;
+}
+
+/**
+ * @brief Escreve um inteiro com sinal (zigzag + varint) no buffer de gravação.
+ */
+void RecordSigned(long v)
+{
+   RecordVarint((ulong)((v << 1) ^ (v >> 63)));
+}
+
+/**
+ * @brief Abre o arquivo de gravação (TickRecordFile) e grava o cabeçalho com os símbolos.
+ */
+void RecordOpen()
+{
+   if(TickRecordFile == "" || tickSource == TICK_SOURCE_REPLAY) return;
+   recordHandle = FileOpen(TickRecordFile, FILE_WRITE | FILE_BIN);
+   if(recordHandle == INVALID_HANDLE)
+   {
+      LOG_ERROR("[1300] Não foi possível criar o arquivo de ticks " + TickRecordFile + " (erro " + IntegerToString(GetLastError()) + ")");
+      return;
+   }
+   FileWriteInteger(recordHandle, TICK_FILE_MAGIC);
+   FileWriteInteger(recordHandle, TICK_FILE_VERSION);
+   FileWriteInteger(recordHandle, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      FileWriteInteger(recordHandle, StringLen(symbolArray[i]));
+      FileWriteString(recordHandle, symbolArray[i]);
+      FileWriteDouble(recordHandle, sourceTickSize[i]);
+      FileWriteInteger(recordHandle, sourceDigits[i]);
+      FileWriteInteger(recordHandle, sourceTradeFeed[i] ? 1 : 0);
+   }
+   ArrayResize(recordCodec, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+      ZeroMemory(recordCodec[i]);
+   recordLen = 0;
+   LOG_INFO("[1301] Gravando ticks em " + TickRecordFile);
+}
+
+/**
+ * @brief Codifica um tick no buffer de gravação (gravado no arquivo em RecordFlush).
+ */
+void RecordTick(int i, const MqlTick &tick)
+{
+   double ts = sourceTickSize[i];
+   long bid = (long)MathRound(tick.bid / ts);
+   long ask = (long)MathRound(tick.ask / ts);
+   long last = (long)MathRound(tick.last / ts);
+   
+   RecordVarint((ulong)i);
+   RecordSigned(tick.time_msc - recordCodec[i].msc);
+   RecordSigned(bid - recordCodec[i].bid);
+   RecordSigned(ask - recordCodec[i].ask);
+   RecordSigned(last - recordCodec[i].last);
+   RecordVarint(tick.volume);
+   RecordVarint(tick.flags);
+   
+   recordCodec[i].msc = tick.time_msc;
+   recordCodec[i].bid = bid;
+   recordCodec[i].ask = ask;
+   recordCodec[i].last = last;
+}
+
+/**
+ * @brief Grava no arquivo os bytes codificados no frame (uma escrita por frame).
+ */
+void RecordFlush()
+{
+   if(recordHandle == INVALID_HANDLE || recordLen == 0) return;
+   FileWriteArray(recordHandle, recordBuf, 0, recordLen);
+   recordLen = 0;
+}
+
+/**
+ * @brief Grava o que restou no buffer e fecha o arquivo de gravação.
+ */
+void RecordClose()
+{
+   if(recordHandle == INVALID_HANDLE) return;
+   RecordFlush();
+   FileClose(recordHandle);
+   recordHandle = INVALID_HANDLE;
+}
+
+/**
+ * @brief Lê um byte do arquivo de reprodução, carregando um novo bloco quando necessário.
+ * @return false no fim do arquivo.
+ */
+bool ReplayByte(uchar &b)
+{
+   if(replayPos >= replayLen)
+   {
+      replayLen = (int)FileReadArray(replayHandle, replayBuf, 0, TICK_FILE_CHUNK);
+      replayPos = 0;
+      if(replayLen <= 0) return false;
+   }
+   b = replayBuf[replayPos++];
+   return true;
+}
+
+/**
+ * @brief Lê um inteiro sem sinal em formato varint do arquivo de reprodução.
+ */
+bool ReplayVarint(ulong &v)
+{
+   v = 0;
+   uchar b;
+   for(int shift = 0; shift < 64; shift += 7)
+   {
+      if(!ReplayByte(b)) return false;
+      v |= (ulong)(b & 0x7F) << shift;
+      if((b & 0x80) == 0) return true;
+   }
+   return false;
+}
+
+/**
+ * @brief Lê um inteiro com sinal (zigzag + varint) do arquivo de reprodução.
+ */
+bool ReplaySigned(long &v)
+{
+   ulong u;
+   if(!ReplayVarint(u)) return false;
+   v = (long)(u >> 1) ^ -(long)(u & 1);
+   return true;
+}
+
+/**
+ * @brief Abre o arquivo de reprodução e carrega os símbolos do cabeçalho em symbolArray.
+ * @return true se o arquivo é válido.
+ */
+bool ReplayOpen()
+{
+   ReplayClose();
+   replayHandle = FileOpen(TickReplayFile, FILE_READ | FILE_BIN);
+   if(replayHandle == INVALID_HANDLE)
+   {
+      LOG_ERROR("[1302] Arquivo de ticks não encontrado: " + TickReplayFile);
+      return false;
+   }
+   if(FileReadInteger(replayHandle) != TICK_FILE_MAGIC || FileReadInteger(replayHandle) != TICK_FILE_VERSION)
+   {
+      LOG_ERROR("[1303] Arquivo de ticks inválido ou de outra versão: " + TickReplayFile);
+      ReplayClose();
+      return false;
+   }
+   
+   int n = FileReadInteger(replayHandle);
+   ArrayResize(symbolArray, n);
+   ArrayResize(sourceTickSize, n);
+   ArrayResize(sourceDigits, n);
+   ArrayResize(sourceTradeFeed, n);
+   ArrayResize(replayCodec, n);
+   for(int i = 0; i < n; i++)
+   {
+      int len = FileReadInteger(replayHandle);
+      symbolArray[i] = FileReadString(replayHandle, len);
+      sourceTickSize[i] = FileReadDouble(replayHandle);
+      sourceDigits[i] = FileReadInteger(replayHandle);
+      sourceTradeFeed[i] = FileReadInteger(replayHandle) != 0;
+      ZeroMemory(replayCodec[i]);
+   }
+   
+   ArrayResize(replayBuf, TICK_FILE_CHUNK);
+   replayLen = 0;
+   replayPos = 0;
+   replayHasNext = false;
+   sourceClockMsc = 0;
+   LOG_INFO("[1304] Reproduzindo " + IntegerToString(n) + " símbolos de " + TickReplayFile);
+   return true;
+}
+
+/**
+ * @brief Fecha o arquivo de reprodução.
+ */
+void ReplayClose()
+{
+   if(replayHandle != INVALID_HANDLE)
+      FileClose(replayHandle);
+   replayHandle = INVALID_HANDLE;
+   replayHasNext = false;
+}
+
+/**
+ * @brief Decodifica o próximo tick do arquivo em replayNext.
+ * @return false no fim do arquivo.
+ */
+bool ReplayDecodeNext()
+{
+   ulong sym, volume, flags;
+   long dMsc, dBid, dAsk, dLast;
+   if(!ReplayVarint(sym) || !ReplaySigned(dMsc) || !ReplaySigned(dBid) || !ReplaySigned(dAsk) ||
+      !ReplaySigned(dLast) || !ReplayVarint(volume) || !ReplayVarint(flags))
+      return false;
+   
+   int i = (int)sym;
+   if(i < 0 || i >= ArraySize(replayCodec)) return false;
+   replayCodec[i].msc += dMsc;
+   replayCodec[i].bid += dBid;
+   replayCodec[i].ask += dAsk;
+   replayCodec[i].last += dLast;
+   
+   double ts = sourceTickSize[i];
+   ZeroMemory(replayNext);
+   replayNext.time_msc = replayCodec[i].msc;
+   replayNext.time = (datetime)(replayCodec[i].msc / 1000);
+   replayNext.bid = replayCodec[i].bid * ts;
+   replayNext.ask = replayCodec[i].ask * ts;
+   replayNext.last = replayCodec[i].last * ts;
+   replayNext.volume = volume;
+   replayNext.volume_real = (double)volume;
+   replayNext.flags = (uint)flags;
+   replayNextSymbol = i;
+   replayHasNext = true;
+   return true;
+}
+
+/**
+ * @brief Avança o relógio da reprodução e enfileira os ticks com horário até o novo relógio.
+ * @param stepMsc Avanço do relógio em milissegundos.
+ */
+void ReplayAdvance(long stepMsc)
+{
+   if(replayHandle == INVALID_HANDLE) return;
+   if(!replayHasNext && !ReplayDecodeNext())
+   {
+      ReplayClose();
+      LOG_INFO("[1305] Fim da reprodução de " + TickReplayFile);
+      return;
+   }
+   // O relógio começa no primeiro tick do arquivo
+   if(sourceClockMsc == 0) sourceClockMsc = replayNext.time_msc;
+   sourceClockMsc += stepMsc;
+   
+   while(replayHasNext && replayNext.time_msc <= sourceClockMsc)
+   {
+      TickQueuePush(replayNextSymbol, replayNext);
+      replayHasNext = false;
+      ReplayDecodeNext();
+   }
+}
+
+/**
+ * @brief Cria os símbolos do gerador sintético (SYN0001, SYN0002, ...).
+ * @param count Número de símbolos.
+ */
+void SyntheticSymbolsCreate(int count)
+{
+   totalSymbols = MathMax(count, 1);
+   ArrayResize(symbolArray, totalSymbols);
+   ArrayResize(sourceTickSize, totalSymbols);
+   ArrayResize(sourceDigits, totalSymbols);
+   ArrayResize(sourceTradeFeed, totalSymbols);
+   ArrayResize(synthBid, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      symbolArray[i] = StringFormat("SYN%04d", i + 1);
+      sourceTickSize[i] = SYNTH_TICK_SIZE;
+      sourceDigits[i] = 2;
+      sourceTradeFeed[i] = true;
+      synthBid[i] = 10000 + 100 * i; // Preços iniciais distintos (100.00, 101.00, ...)
+   }
+   // Semente e relógio fixos: a mesma configuração gera sempre a mesma sessão
+   MathSrand(SYNTH_SEED);
+   sourceClockMsc = (long)D'2025.01.02 09:00' * 1000;
+}
+
+/**
+ * @brief Gera os ticks sintéticos de um frame: passeio aleatório de preço, spread de 1 a 3
+ *        ticks e negócios com agressor e volume aleatórios, distribuídos entre os símbolos.
+ * @param stepMsc Avanço do relógio em milissegundos.
+ */
+void SyntheticAdvance(long stepMsc)
+{
+   int count = (int)((long)SyntheticTicksPerSec * stepMsc / 1000);
+   MqlTick tick;
+   for(int k = 0; k < count; k++)
+   {
+      int i = MathRand() % totalSymbols;
+      synthBid[i] += (MathRand() % 3) - 1;
+      long spread = 1 + MathRand() % 3;
+      bool buy = (MathRand() & 1) == 1;
+      
+      ZeroMemory(tick);
+      tick.time_msc = sourceClockMsc + (stepMsc * k) / MathMax(count, 1);
+      tick.time = (datetime)(tick.time_msc / 1000);
+      tick.bid = synthBid[i] * SYNTH_TICK_SIZE;
+      tick.ask = (synthBid[i] + spread) * SYNTH_TICK_SIZE;
+      tick.last = buy ? tick.ask : tick.bid;
+      tick.volume = 1 + MathRand() % 10;
+      tick.volume_real = (double)tick.volume;
+      tick.flags = TICK_FLAG_BID | TICK_FLAG_ASK | TICK_FLAG_LAST | TICK_FLAG_VOLUME | (buy ? TICK_FLAG_BUY : TICK_FLAG_SELL);
+      TickQueuePush(i, tick);
+   }
+   sourceClockMsc += stepMsc;
+}
+
+//+------------------------------------------------------------------+
+//| Chamadas Contadas à API de Objetos                               |
+//| Todo o painel cria e altera objetos por estas funções, que       |
+//| contam as chamadas por tipo para o benchmark.                    |
+//+------------------------------------------------------------------+
+
+bool PanelObjectCreate(string name, ENUM_OBJECT type)
+{
+   apiCalls[TD_API_CREATE]++;
+   return ObjectCreate(0, name, type, 0, 0, 0);
+}
+
+bool PanelSetInteger(string name, ENUM_OBJECT_PROPERTY_INTEGER prop, long value)
+{
+   apiCalls[TD_API_SET_INTEGER]++;
+   return ObjectSetInteger(0, name, prop, value);
+}
+
+bool PanelSetString(string name, ENUM_OBJECT_PROPERTY_STRING prop, string value)
+{
+   apiCalls[TD_API_SET_STRING]++;
+   return ObjectSetString(0, name, prop, value);
+}
+
+void PanelRedraw()
+{
+   apiCalls[TD_API_REDRAW]++;
+   ChartRedraw(0);
+}
+
+/**
+ * @brief Total de chamadas à API de objetos desde o início.
+ */
+long ApiCallsTotal()
+{
+   long total = 0;
+   for(int k = 0; k < TD_API_COUNT; k++)
+      total += apiCalls[k];
+   return total;
+}
+
+//+------------------------------------------------------------------+
+//| Benchmark do Painel                                              |
+//| Com RunBenchmark, o OnInit monta o painel com 1 a 500 símbolos   |
+//| sintéticos e mede, para cada tamanho, a criação, um frame com    |
+//| carga sintética, a troca de aba e o minimizar/restaurar: tempo   |
+//| (µs), chamadas à API de objetos e a variação da memória usada    |
+//| pelo programa (MQL_MEMORY_USED, em MB; o MQL5 não expõe contagem |
+//| de alocações, então a variação de memória as substitui). Os      |
+//| frames medidos ignoram FrameBudgetMs e o CSV traz os símbolos    |
+//| recalculados por frame e os adiados (0 nessa medição). Cada      |
+//| tamanho é medido com algumas máscaras de linhas Show* (todas, só |
+//| fluxo, só Médias/Indicadores e a configuração atual), gravadas   |
+//| na coluna show_mask, para comparar o custo de cada bloco e       |
+//| execuções com configurações e versões diferentes. Uma segunda    |
+//| tabela no mesmo arquivo traz os casos de verificação: tempo por  |
+//| operação e divergências entre cálculos que devem coincidir.      |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Máscara das linhas Show* ativas (bit 0 = ShowStatus, na ordem das entradas).
+ */
+int ShowRowsMask()
+{
+   bool rows[11];
+   rows[0] = ShowStatus;    rows[1] = ShowAcoes;      rows[2] = ShowScore;
+   rows[3] = ShowPontuation; rows[4] = ShowPressaoDOM; rows[5] = ShowDelta;
+   rows[6] = ShowLiquidity; rows[7] = ShowSpread;     rows[8] = ShowMAs;
+   rows[9] = ShowIndicators; rows[10] = ShowResults;
+   int mask = 0;
+   for(int k = 0; k < ArraySize(rows); k++)
+      if(rows[k]) mask |= 1 << k;
+   return mask;
+}
+
+/**
+ * @brief Desfaz o painel e os estados por símbolo montados para uma medição.
+ */
+void BenchmarkTeardown()
+{
+   ReleaseIndicatorPool();
+   ObjectsDeleteAll(0, "TD_");
+   CanvasDestroy();
+}
+
+/**
+ * @brief Mede o painel com `count` símbolos sintéticos e as linhas de `showMask` visíveis
+ *        e grava uma linha no CSV.
+ */
+void BenchmarkRun(int file, int count, int showMask)
+{
+   benchSymbols = count;
+   ProcessSymbols();
+   ResetRowSchema(showMask);
+   ResetMetricStore();
+   ResetScheduler();
+   LatencyReset();
+   ResetBarCache();
+   ResetIndicatorSeries();
+   ResetIndicatorPool();
+   ResetScoring();
+   ResetTickStreams();
+   ResetRelVolume();
+   ResetResults();
+   SubscribeBooks();
+   CalculatePanelSize();
+   activeTab = 2;
+   panelMinimized = false;
+   long mem0 = MQLInfoInteger(MQL_MEMORY_USED);
+   
+   // Criação
+   long calls = ApiCallsTotal();
+   ulong t = GetMicrosecondCount();
+   CreatePanel();
+   ulong createUs = GetMicrosecondCount() - t;
+   long createCalls = ApiCallsTotal() - calls;
+   
+   // Frames com carga sintética, sem o orçamento do frame: o tempo medido é o custo real de
+   // recalcular todos os símbolos pendentes, e não o limite de FrameBudgetMs
+   calls = ApiCallsTotal();
+   ulong deferred = symbolsDeferred, recomputed = symbolsRecomputed;
+   benchBudgetUs = ULONG_MAX;
+   t = GetMicrosecondCount();
+   for(int f = 0; f < BENCH_FRAMES; f++)
+      UpdatePanelValues();
+   double frameUs = (double)(GetMicrosecondCount() - t) / BENCH_FRAMES;
+   benchBudgetUs = 0;
+   double frameCalls = (double)(ApiCallsTotal() - calls) / BENCH_FRAMES;
+   double frameSymbols = (double)(symbolsRecomputed - recomputed) / BENCH_FRAMES;
+   long frameDeferred = (long)(symbolsDeferred - deferred);
+   
+   // Troca de aba (ida e volta conta duas trocas)
+   calls = ApiCallsTotal();
+   t = GetMicrosecondCount();
+   for(int k = 0; k < BENCH_SWITCHES; k++)
+   {
+      SwitchTab(1);
+      SwitchTab(2);
+   }
+   double switchUs = (double)(GetMicrosecondCount() - t) / (2 * BENCH_SWITCHES);
+   double switchCalls = (double)(ApiCallsTotal() - calls) / (2 * BENCH_SWITCHES);
+   
+   // Minimizar e restaurar
+   calls = ApiCallsTotal();
+   t = GetMicrosecondCount();
+   for(int k = 0; k < BENCH_SWITCHES; k++)
+   {
+      ToggleMinimize();
+      ToggleMinimize();
+   }
+   double minimizeUs = (double)(GetMicrosecondCount() - t) / (2 * BENCH_SWITCHES);
+   double minimizeCalls = (double)(ApiCallsTotal() - calls) / (2 * BENCH_SWITCHES);
+   // Variação (MB) da memória usada pelo programa no lugar de uma contagem de alocações
+   long memDeltaMb = MQLInfoInteger(MQL_MEMORY_USED) - mem0;
+   
+   FileWrite(file, count, showMask, UseCanvasRenderer ? 1 : 0,
+             createUs, createCalls,
+             DoubleToString(frameUs, 1), DoubleToString(frameCalls, 1),
+             DoubleToString(frameSymbols, 1), frameDeferred,
+             DoubleToString(switchUs, 1), DoubleToString(switchCalls, 1),
+             DoubleToString(minimizeUs, 1), DoubleToString(minimizeCalls, 1),
+             memDeltaMb);
+   
+   BenchmarkTeardown();
+   LOG_INFO("[1400] Benchmark " + IntegerToString(count) + " símbolos, linhas 0x" + StringFormat("%03X", showMask) + ": criação " + IntegerToString((long)createUs) +
+            " µs, frame " + DoubleToString(frameUs, 0) + " µs, troca de aba " + DoubleToString(switchUs, 0) + " µs");
+}
+
+/**
+ * @brief Grava uma linha da tabela de verificações do benchmark e reporta as divergências.
+ * @param name       Nome do caso.
+ * @param iterations Operações medidas (ou comparações feitas).
+ * @param usPerOp    Tempo médio por operação (µs).
+ * @param mismatches Comparações fora da tolerância.
+ */
+void BenchmarkCase(int file, string name, int iterations, double usPerOp, int mismatches)
+{
+   FileWrite(file, name, iterations, DoubleToString(usPerOp, 3), mismatches);
+   if(mismatches > 0)
+      LOG_ERROR(StringFormat("[1403] Verificação %s: %d de %d comparações divergem", name, mismatches, iterations));
+}
+
+/**
+ * @brief Executa o benchmark para 1 a 500 símbolos, cada tamanho com algumas combinações de
+ *        linhas Show*, e grava os resultados em BenchmarkFile, seguidos da tabela de
+ *        verificações (casos de custo e de conferência dos cálculos).
+ */
+void RunPanelBenchmark()
+{
+   int file = FileOpen(BenchmarkFile, FILE_WRITE | FILE_CSV | FILE_ANSI, ',');
+   if(file == INVALID_HANDLE)
+   {
+      LOG_ERROR("[1401] Não foi possível criar o arquivo do benchmark " + BenchmarkFile);
+      return;
+   }
+   FileWrite(file, "symbols", "show_mask", "canvas",
+             "create_us", "create_calls", "frame_us", "frame_calls", "frame_symbols", "frame_deferred",
+             "switch_us", "switch_calls", "minimize_us", "minimize_calls", "memory_used_delta_mb");
+   
+   int sizes[] = {1, 10, 50, 100, 250, 500};
+   // Todas as linhas; só as linhas de fluxo (Status a Spread); só Médias e Indicadores
+   // (linhas com indicadores e séries); e a configuração atual, se for outra
+   int masks[] = {SHOW_ROWS_ALL, 0x0FF, 0x300, 0};
+   masks[3] = ShowRowsMask();
+   int maskCount = (masks[3] == masks[0] || masks[3] == masks[1] || masks[3] == masks[2] || masks[3] == 0) ? 3 : 4;
+   ENUM_TD_TICK_SOURCE configured = tickSource;
+   tickSource = TICK_SOURCE_SYNTHETIC;
+   for(int k = 0; k < ArraySize(sizes); k++)
+      for(int m = 0; m < maskCount; m++)
+         BenchmarkRun(file, sizes[k], masks[m]);
+   tickSource = configured;
+   benchSymbols = 0;
+   sourceClockMsc = 0;
+   
+   FileWrite(file, "");
+   FileWrite(file, "case", "iterations", "us_per_op", "mismatches");
+   int mismatches = SeriesSelfCheck(file);
+   mismatches += BookBenchmark(file);
+   mismatches += WarmupBenchmark(file, sizes[ArraySize(sizes) - 1]);
+   
+   FileClose(file);
+   LOG_INFO("[1402] Benchmark gravado em " + BenchmarkFile + " (" + IntegerToString(mismatches) + " divergências nas verificações)");
+   LogFlush();
+}
+
+//+------------------------------------------------------------------+
+//| Motor de Delta de Agressão                                       |
+//| Em bolsa, o lado agressor vem de TICK_FLAG_BUY/TICK_FLAG_SELL    |
+//| (ou da posição do negócio no bid/ask). Em FX, sem negócios, cada |
+//| movimento das cotações conta como uma agressão de volume 1.      |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Zera o delta da sessão e da janela móvel.
+ */
+void DeltaReset(DeltaState &d, datetime sessionDay)
+{
+   d.sessionDay = sessionDay;
+   d.sessionDelta = 0.0;
+   d.lastBid = 0.0;
+   d.lastAsk = 0.0;
+   d.lastTrade = 0.0;
+   d.lastSide = 0;
+   int w = MathMax(DeltaWindowMinutes, 1);
+   ArrayResize(d.bucket, w);
+   ArrayResize(d.bucketMinute, w);
+   ArrayInitialize(d.bucket, 0.0);
+   ArrayInitialize(d.bucketMinute, -1);
+   d.windowDelta = 0.0;
+}
+
+/**
+ * @brief Classifica um tick e soma sua agressão ao delta da sessão e da janela.
+ * @param d         Estado do delta do símbolo.
+ * @param tradeFeed true se o símbolo tem ticks de negócio (bolsa).
+ * @param tick      Tick a ser processado.
+ */
+void DeltaOnTick(DeltaState &d, bool tradeFeed, const MqlTick &tick)
+{
+   // Virada de dia: começa uma nova sessão
+   datetime day = SessionStart(tick.time);
+   if(day != d.sessionDay)
+      DeltaReset(d, day);
+   
+   int side = 0;
+   double volume = 0.0;
+   
+   if(tradeFeed)
+   {
+      if((tick.flags & TICK_FLAG_LAST) == 0) return; // Apenas cotação: não é agressão
+      volume = (tick.volume_real > 0.0) ? tick.volume_real : (double)tick.volume;
+      
+      if((tick.flags & TICK_FLAG_BUY) != 0 && (tick.flags & TICK_FLAG_SELL) == 0) side = 1;
+      else if((tick.flags & TICK_FLAG_SELL) != 0 && (tick.flags & TICK_FLAG_BUY) == 0) side = -1;
+      // Sem agressor informado: negócio no ask é compra, no bid é venda
+      else if(tick.ask > 0.0 && tick.last >= tick.ask) side = 1;
+      else if(tick.bid > 0.0 && tick.last <= tick.bid) side = -1;
+      // Entre o bid e o ask: regra do tick (mesmo preço mantém o último lado)
+      else if(tick.last > d.lastTrade) side = 1;
+      else if(tick.last < d.lastTrade) side = -1;
+      else side = d.lastSide;
+      
+      d.lastTrade = tick.last;
+   }
+   else
+   {
+      // FX: regra bid/ask. Subida das cotações = compra, queda = venda
+      double bid = (tick.bid > 0.0) ? tick.bid : d.lastBid;
+      double ask = (tick.ask > 0.0) ? tick.ask : d.lastAsk;
+      if(d.lastBid > 0.0 && d.lastAsk > 0.0)
+      {
+         double move = (bid + ask) - (d.lastBid + d.lastAsk);
+         if(move > 0.0) side = 1;
+         else if(move < 0.0) side = -1;
+      }
+      d.lastBid = bid;
+      d.lastAsk = ask;
+      volume = 1.0;
+   }
+   
+   if(side == 0) return;
+   d.lastSide = side;
+   
+   double signedVolume = side * volume;
+   d.sessionDelta += signedVolume;
+   
+   // Janela móvel: um balde por minuto, reaproveitado quando o minuto sai da janela
+   long minute = tick.time / 60;
+   int w = ArraySize(d.bucket);
+   int slot = (int)(minute % w);
+   if(d.bucketMinute[slot] != minute)
+   {
+      d.bucket[slot] = 0.0;
+      d.bucketMinute[slot] = minute;
+   }
+   d.bucket[slot] += signedVolume;
+}
+
+/**
+ * @brief Descarta os minutos que saíram da janela móvel e recalcula seu total (O(janela)).
+ * @param d          Estado do delta do símbolo.
+ * @param nowMinute  Minuto atual (tempo / 60).
+ */
+void DeltaExpireWindow(DeltaState &d, long nowMinute)
+{
+   int w = ArraySize(d.bucket);
+   d.windowDelta = 0.0;
+   for(int k = 0; k < w; k++)
+   {
+      if(d.bucketMinute[k] <= nowMinute - w)
+      {
+         d.bucket[k] = 0.0;
+         d.bucketMinute[k] = -1;
+      }
+      d.windowDelta += d.bucket[k];
+   }
+}
+
+//+------------------------------------------------------------------+
+//| Perfil de Volume (Liquidez Maior)                                |
+//| Histograma da sessão com um nível por tick size, indexado pela   |
+//| distância ao preço base (sem hash). Como os volumes só crescem   |
+//| durante a sessão, o POC é mantido por um máximo corrente em O(1).|
+//| O histograma não passa de PROFILE_MAX_BINS níveis: um print      |
+//| distante da faixa da sessão é descartado em vez de dobrá-lo.     |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Prepara o perfil de volume de um símbolo para a sessão informada.
+ */
+void ProfileReset(VolumeProfile &p, datetime sessionDay, double tickSize)
+{
+   p.tickSize = tickSize;
+   ProfileClear(p, sessionDay);
+}
+
+/**
+ * @brief Esvazia o histograma para uma nova sessão (mantém o tick size).
+ */
+void ProfileClear(VolumeProfile &p, datetime sessionDay)
+{
+   p.sessionDay = sessionDay;
+   p.baseTick = 0;
+   p.binCount = 0;
+   ArrayFree(p.bins);
+   p.maxVolume = 0.0;
+   p.pocBin = -1;
+}
+
+/**
+ * @brief Garante que o nível de preço (em ticks) exista no histograma e retorna seu índice.
+ *        O histograma cresce dobrando de tamanho, até PROFILE_MAX_BINS; ao crescer para
+ *        baixo, os níveis existentes são deslocados uma única vez para o novo preço base.
+ * @return Índice do nível, ou -1 se o preço exigiria um histograma maior que PROFILE_MAX_BINS
+ *         (negócio fora da faixa da sessão, como um print errado; o tick é descartado).
+ */
+int ProfileBin(VolumeProfile &p, long priceTick)
+{
+   // Primeiro negócio da sessão: centraliza o histograma no preço
+   if(p.binCount == 0)
+   {
+      p.binCount = PROFILE_INITIAL_BINS;
+      ArrayResize(p.bins, p.binCount);
+      ArrayInitialize(p.bins, 0.0);
+      p.baseTick = priceTick - PROFILE_INITIAL_BINS / 2;
+   }
+   
+   // Contas em long: um preço muito distante não pode estourar o tamanho calculado
+   long offset = priceTick - p.baseTick;
+   if(offset >= p.binCount)
+   {
+      // Cresce para cima: os índices atuais continuam válidos
+      if(offset >= PROFILE_MAX_BINS) return -1;
+      long newCount = p.binCount;
+      while(offset >= newCount) newCount *= 2;
+      if(newCount > PROFILE_MAX_BINS) newCount = PROFILE_MAX_BINS;
+      ArrayResize(p.bins, (int)newCount);
+      ArrayFill(p.bins, p.binCount, (int)newCount - p.binCount, 0.0);
+      p.binCount = (int)newCount;
+   }
+   else if(offset < 0)
+   {
+      // Cresce para baixo: desloca os níveis e o POC pela mesma quantidade
+      long needed = p.binCount - offset;
+      if(needed > PROFILE_MAX_BINS) return -1;
+      long total = 2 * (long)p.binCount;
+      while(total < needed) total *= 2;
+      if(total > PROFILE_MAX_BINS) total = PROFILE_MAX_BINS;
+      int shift = (int)(total - p.binCount);
+      ArrayResize(p.bins, p.binCount + shift);
+      for(int k = p.binCount - 1; k >= 0; k--)
+         p.bins[k + shift] = p.bins[k];
+      ArrayFill(p.bins, 0, shift, 0.0);
+      p.binCount += shift;
+      p.baseTick -= shift;
+      if(p.pocBin >= 0) p.pocBin += shift;
+      offset += shift;
+   }
+   return (int)offset;
+}
+
+/**
+ * @brief Soma o volume de um tick ao seu nível de preço e atualiza o POC.
+ * @param p         Perfil de volume do símbolo.
+ * @param tradeFeed true se o símbolo tem ticks de negócio (bolsa).
+ * @param tick      Tick a ser processado.
+ */
+void ProfileOnTick(VolumeProfile &p, bool tradeFeed, const MqlTick &tick)
+{
+   datetime day = SessionStart(tick.time);
+   if(day != p.sessionDay)
+      ProfileClear(p, day);
+   
+   double price, volume;
+   if(tradeFeed)
+   {
+      // Bolsa: volume negociado no preço do negócio
+      if((tick.flags & TICK_FLAG_LAST) == 0 || tick.last <= 0.0) return;
+      price = tick.last;
+      volume = (tick.volume_real > 0.0) ? tick.volume_real : (double)tick.volume;
+   }
+   else
+   {
+      // FX: sem volume real, cada mudança de cotação conta 1 no preço de compra
+      if((tick.flags & TICK_FLAG_BID) == 0 || tick.bid <= 0.0) return;
+      price = tick.bid;
+      volume = 1.0;
+   }
+   if(volume <= 0.0) return;
+   
+   int bin = ProfileBin(p, (long)MathRound(price / p.tickSize));
+   if(bin < 0) return;
+   p.bins[bin] += volume;
+   if(p.bins[bin] > p.maxVolume)
+   {
+      p.maxVolume = p.bins[bin];
+      p.pocBin = bin;
+   }
+}
+
+/**
+ * @brief Formata um valor grande de forma compacta (ex.: 12.3K, -1.2M).
+ */
+string FormatCompact(double v)
+{
+   double a = MathAbs(v);
+   if(a >= 1000000.0) return DoubleToString(v / 1000000.0, 1) + "M";
+   if(a >= 10000.0) return DoubleToString(v / 1000.0, 1) + "K";
+   return DoubleToString(v, 0);
+}
+
+//+------------------------------------------------------------------+
+//| Distribuição do Spread                                           |
+//| Cada tick soma 1 à faixa do seu spread (em ticks) no histograma  |
+//| da sessão. A memória é fixa (SPREAD_BINS) e o custo por tick é   |
+//| constante; mediana, p95 e o percentil do spread atual são lidos  |
+//| do histograma só quando o símbolo é recalculado.                 |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Zera a distribuição do spread para uma nova sessão.
+ */
+void SpreadReset(SpreadStats &st, datetime sessionDay, double tickSize)
+{
+   st.sessionDay = sessionDay;
+   st.tickSize = (tickSize > 0.0) ? tickSize : 1.0;
+   ArrayInitialize(st.bins, 0);
+   st.count = 0;
+   st.current = -1;
+}
+
+/**
+ * @brief Soma o spread de um tick à distribuição da sessão.
+ */
+void SpreadOnTick(SpreadStats &st, const MqlTick &tick)
+{
+   datetime day = SessionStart(tick.time);
+   if(day != st.sessionDay)
+      SpreadReset(st, day, st.tickSize);
+   
+   if(tick.bid <= 0.0 || tick.ask < tick.bid) return; // Sem as duas cotações (ou cruzadas)
+   int spread = (int)MathMin(MathRound((tick.ask - tick.bid) / st.tickSize), SPREAD_BINS - 1);
+   st.bins[spread]++;
+   st.count++;
+   st.current = spread;
+}
+
+/**
+ * @brief Quantil da distribuição do spread.
+ * @param q Fração de 0 a 1 (0.5 = mediana).
+ * @return Spread em ticks, ou -1 se a distribuição está vazia.
+ */
+int SpreadQuantile(const SpreadStats &st, double q)
+{
+   if(st.count == 0) return -1;
+   long target = MathMax((long)MathCeil(q * st.count), 1), seen = 0;
+   for(int b = 0; b < SPREAD_BINS; b++)
+   {
+      seen += st.bins[b];
+      if(seen >= target) return b;
+   }
+   return SPREAD_BINS - 1;
+}
+
+/**
+ * @brief Percentil de um spread na distribuição da sessão (os empates contam pela metade).
+ * @return De 0 (menor spread visto) a 100 (maior spread visto).
+ */
+double SpreadPercentile(const SpreadStats &st, int spread)
+{
+   if(st.count == 0) return 50.0;
+   long below = 0;
+   for(int b = 0; b < spread; b++)
+      below += st.bins[b];
+   return (below + 0.5 * st.bins[spread]) * 100.0 / st.count;
+}
+
+/**
+ * @brief Spread em ticks como texto (a última faixa acumula os maiores).
+ */
+string SpreadText(int spread)
+{
+   if(spread < 0) return "-";
+   return (spread >= SPREAD_BINS - 1) ? IntegerToString(SPREAD_BINS - 1) + "+" : IntegerToString(spread);
+}
+
+//+------------------------------------------------------------------+
+//| Volume Relativo                                                  |
+//| A média do volume acumulado até cada minuto do dia, nos últimos  |
+//| RelVolumeDays dias, é montada uma vez por sessão a partir do     |
+//| histórico M1 e guardada em disco (um arquivo por símbolo). Na    |
+//| sessão, cada barra M1 fechada soma seu volume ao acumulado do    |
+//| dia em O(1), lido pelo cache de barras.                          |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Prepara o volume relativo de todos os símbolos (a média é carregada ou montada
+ *        no primeiro recálculo de cada símbolo).
+ */
+void ResetRelVolume()
+{
+   ArrayResize(relVolumes, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      // Símbolos reproduzidos ou sintéticos não têm histórico M1 no terminal
+      relVolumes[i].cacheSlot = (tickSource == TICK_SOURCE_LIVE) ? BarCacheGet(symbolArray[i], PERIOD_M1, 2) : -1;
+      relVolumes[i].baselineDay = 0;
+      relVolumes[i].baselineDays = 0;
+      relVolumes[i].sessionDay = 0;
+      relVolumes[i].sessionVolume = 0.0;
+      relVolumes[i].seenClosed = 0;
+      relVolumes[i].seenReload = -1;
+   }
+   relVolumeBuilds = 0;
+}
+
+/**
+ * @brief Volume de uma barra: volume real quando o símbolo o informa, senão o de ticks.
+ */
+double RelVolumeBarVolume(const MqlRates &bar)
+{
+   return (bar.real_volume > 0) ? (double)bar.real_volume : (double)bar.tick_volume;
+}
+
+/**
+ * @brief Nome do arquivo da média de um símbolo (pasta Files do terminal).
+ */
+string RelVolumeFile(int i)
+{
+   string name = symbolArray[i];
+   StringReplace(name, "/", "_");
+   StringReplace(name, "\\", "_");
+   return "td_relvol_" + name + ".bin";
+}
+
+/**
+ * @brief Carrega a média do disco se ela foi montada para a sessão `day` com os mesmos parâmetros.
+ */
+bool RelVolumeLoad(int i, datetime day)
+{
+   string file = RelVolumeFile(i);
+   if(!FileIsExist(file)) return false;
+   int h = FileOpen(file, FILE_READ | FILE_BIN);
+   if(h == INVALID_HANDLE) return false;
+   bool ok = FileReadInteger(h) == RELVOL_MAGIC && FileReadInteger(h) == RELVOL_VERSION &&
+             FileReadInteger(h) == RelVolumeDays && (datetime)FileReadLong(h) == day;
+   int days = ok ? FileReadInteger(h) : 0;
+   ok = ok && FileReadArray(h, relVolumes[i].baseline, 0, RELVOL_MINUTES) == RELVOL_MINUTES;
+   FileClose(h);
+   if(!ok) return false;
+   relVolumes[i].baselineDay = day;
+   relVolumes[i].baselineDays = days;
+   return true;
+}
+
+/**
+ * @brief Grava a média do símbolo no disco para os próximos anexos na mesma sessão.
+ */
+void RelVolumeSave(int i)
+{
+   int h = FileOpen(RelVolumeFile(i), FILE_WRITE | FILE_BIN);
+   if(h == INVALID_HANDLE)
+   {
+      LOG_WARN("[2501] Não foi possível gravar a média de volume de " + symbolArray[i]);
+      return;
+   }
+   FileWriteInteger(h, RELVOL_MAGIC);
+   FileWriteInteger(h, RELVOL_VERSION);
+   FileWriteInteger(h, RelVolumeDays);
+   FileWriteLong(h, (long)relVolumes[i].baselineDay);
+   FileWriteInteger(h, relVolumes[i].baselineDays);
+   FileWriteArray(h, relVolumes[i].baseline, 0, RELVOL_MINUTES);
+   FileClose(h);
+}
+
+/**
+ * @brief Indica se o dia mais antigo de uma cópia do histórico está completo: a cópia é limitada
+ *        pela quantidade de barras (ou pelo início do histórico) e pode começar no meio do dia.
+ * @param barDay   Início (00:00) do dia.
+ * @param firstBar Primeira barra copiada desse dia.
+ * @return true se a primeira barra está na abertura da sessão de negociação do dia.
+ */
+bool RelVolumeDayComplete(int i, datetime barDay, datetime firstBar)
+{
+   MqlDateTime dt;
+   TimeToStruct(barDay, dt);
+   datetime from, to;
+   if(!SymbolInfoSessionTrade(symbolArray[i], (ENUM_DAY_OF_WEEK)dt.day_of_week, 0, from, to))
+      return false; // Sem horário de sessão não há como saber: o dia é descartado
+   return firstBar - barDay <= (long)from;
+}
+
+/**
+ * @brief Monta a média a partir do histórico M1: para cada um dos últimos RelVolumeDays dias
+ *        com volume (anteriores a `day`), o volume acumulado até cada minuto. Só entram sessões
+ *        completas: o dia mais antigo da cópia é descartado se não começa na abertura da sessão.
+ * @return false se o histórico ainda não está disponível (tenta de novo em outro frame).
+ */
+bool RelVolumeBuild(int i, datetime day)
+{
+   int days = MathMax(RelVolumeDays, 1);
+   MqlRates rates[];
+   // Até RELVOL_MINUTES barras por dia cobrem os dias pedidos mesmo em sessões de 24 h; um dia a
+   // mais compensa o dia mais antigo, que pode vir truncado e ser descartado
+   int got = CopyRates(symbolArray[i], PERIOD_M1, day - 1, (days + 1) * RELVOL_MINUTES, rates);
+   if(got <= 0) return false;
+   
+   double sum[RELVOL_MINUTES], dayVolume[RELVOL_MINUTES];
+   ArrayInitialize(sum, 0.0);
+   ArrayInitialize(dayVolume, 0.0);
+   int used = 0;
+   datetime current = 0, firstBar = 0;
+   
+   // Da barra mais recente para a mais antiga, um dia por vez, até completar os dias pedidos
+   for(int k = got - 1; k >= -1 && used < days; k--)
+   {
+      datetime barDay = (k >= 0) ? SessionStart(rates[k].time) : 0;
+      if(barDay != current)
+      {
+         // Fecha o dia anterior: acumula os minutos e soma à média. Os dias seguidos por outro
+         // na cópia estão inteiros; o último fechado (k = -1) é o mais antigo e pode estar truncado
+         if(current != 0 && (k >= 0 || RelVolumeDayComplete(i, current, firstBar)))
+         {
+            double cumulative = 0.0;
+            for(int m = 0; m < RELVOL_MINUTES; m++)
+            {
+               cumulative += dayVolume[m];
+               sum[m] += cumulative;
+            }
+            if(cumulative > 0.0) used++;
+         }
+         ArrayInitialize(dayVolume, 0.0);
+         current = barDay;
+      }
+      if(k >= 0)
+      {
+         dayVolume[(int)((rates[k].time - barDay) / 60)] += RelVolumeBarVolume(rates[k]);
+         firstBar = rates[k].time;
+      }
+   }
+   if(used == 0) return false;
+   
+   for(int m = 0; m < RELVOL_MINUTES; m++)
+      relVolumes[i].baseline[m] = (float)(sum[m] / used);
+   relVolumes[i].baselineDay = day;
+   relVolumes[i].baselineDays = used;
+   LOG_DEBUG("[2500] Média de volume de " + symbolArray[i] + " montada com " + IntegerToString(used) + " dias");
+   RelVolumeSave(i);
+   return true;
+}
+
+/**
+ * @brief Refaz o volume acumulado da sessão com as barras M1 fechadas desde o início do dia
+ *        (no primeiro uso, na virada do dia e quando o cache recarrega o histórico).
+ */
+void RelVolumeReloadSession(int i, datetime day, datetime formingBar)
+{
+   relVolumes[i].sessionDay = day;
+   relVolumes[i].sessionVolume = 0.0;
+   MqlRates rates[];
+   int got = (formingBar > day) ? CopyRates(symbolArray[i], PERIOD_M1, day, formingBar - 1, rates) : 0;
+   for(int k = 0; k < got; k++)
+      if(rates[k].time >= day && rates[k].time < formingBar)
+         relVolumes[i].sessionVolume += RelVolumeBarVolume(rates[k]);
+}
+
+/**
+ * @brief Volume relativo atual de um símbolo: volume acumulado da sessão (barras fechadas +
+ *        barra em formação) sobre a média acumulada até o mesmo minuto nos últimos dias.
+ * @param i     Índice do símbolo em symbolArray.
+ * @param ratio Recebe o volume relativo (1 = igual à média).
+ * @return false se ainda não há média ou histórico (o valor anterior é mantido).
+ */
+bool RelVolumeRead(int i, double &ratio)
+{
+   int cs = relVolumes[i].cacheSlot;
+   if(cs < 0 || !BarCacheSync(cs)) return false;
+   MqlRates bar;
+   BarCacheBar(cs, 0, bar);
+   datetime day = SessionStart(bar.time);
+   
+   // Média da sessão: do disco, ou montada do histórico (poucas por frame, para não travar o frame)
+   if(relVolumes[i].baselineDay != day && !RelVolumeLoad(i, day))
+   {
+      if(relVolumeBuildFrame != frameNumber)
+      {
+         relVolumeBuildFrame = frameNumber;
+         relVolumeBuilds = 0;
+      }
+      if(relVolumeBuilds >= RELVOL_BUILDS_PER_FRAME)
+      {
+         symbolPending[i] = true; // Orçamento do frame esgotado: monta no próximo frame
+         return false;
+      }
+      relVolumeBuilds++;
+      if(!RelVolumeBuild(i, day)) return false; // Histórico ainda não disponível: tenta no próximo tick
+   }
+   
+   // Acumulado da sessão: soma as barras que fecharam desde a última leitura (normalmente uma)
+   long newClosed = barCache[cs].closedCount - relVolumes[i].seenClosed;
+   if(relVolumes[i].sessionDay != day || relVolumes[i].seenReload != barCache[cs].reloadVersion ||
+      newClosed >= barCache[cs].count)
+      RelVolumeReloadSession(i, day, bar.time);
+   else
+   {
+      MqlRates closed;
+      for(int shift = (int)newClosed; shift >= 1; shift--)
+      {
+         BarCacheBar(cs, shift, closed);
+         if(closed.time >= day)
+            relVolumes[i].sessionVolume += RelVolumeBarVolume(closed);
+      }
+   }
+   relVolumes[i].seenClosed = barCache[cs].closedCount;
+   relVolumes[i].seenReload = barCache[cs].reloadVersion;
+   
+   double base = relVolumes[i].baseline[(int)((bar.time - day) / 60)];
+   if(base <= 0.0) return false; // Minuto sem volume na média (fora do horário de negociação)
+   ratio = (relVolumes[i].sessionVolume + RelVolumeBarVolume(bar)) / base;
+   return true;
+}
+
+//+------------------------------------------------------------------+
+//| Motor de Pressão do DOM                                          |
+//| OnBookEvent copia o livro para um buffer reaproveitado e corrige |
+//| no lugar apenas os níveis que mudaram, mantendo as somas         |
+//| ponderadas de compra e venda. A reserva do buffer acompanha o    |
+//| maior livro visto, então os eventos não alocam; cada evento      |
+//| custa O(BOOK_DEPTH) (os níveis são comparados um a um) e cada    |
+//| nível alterado O(1). A célula só é atualizada por frame.         |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Assina o livro de ofertas de todos os símbolos monitorados.
+ */
+void SubscribeBooks()
+{
+   for(int k = 0; k < BOOK_DEPTH; k++)
+      bookWeight[k] = 1.0 / (k + 1);
+   
+   // Reserva o buffer uma vez; MarketBookGet reaproveita a memória nos eventos seguintes
+   bookReserved = 4 * BOOK_DEPTH;
+   ArrayResize(bookBuffer, 0, bookReserved);
+   
+   ArrayResize(bookStates, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      BookReset(bookStates[i]);
+      if(tickSource != TICK_SOURCE_LIVE) continue; // Sem livro fora do modo ao vivo
+      bookStates[i].subscribed = MarketBookAdd(symbolArray[i]);
+      if(!bookStates[i].subscribed)
+         LOG_WARN("[0500] Livro de ofertas indisponível para " + symbolArray[i]);
+      // A profundidade real vem da corretora: a primeira leitura já dimensiona a reserva
+      else if(MarketBookGet(symbolArray[i], bookBuffer))
+         BookReserve();
+   }
+}
+
+/**
+ * @brief Amplia a reserva de bookBuffer quando MarketBookGet devolveu um livro maior que
+ *        a reserva atual, para que os eventos seguintes desse tamanho não aloquem.
+ */
+void BookReserve()
+{
+   int total = ArraySize(bookBuffer);
+   if(total <= bookReserved) return;
+   bookReserved = 2 * total;
+   ArrayResize(bookBuffer, total, bookReserved - total);
+}
+
+/**
+ * @brief Cancela as assinaturas de livro feitas em SubscribeBooks.
+ */
+void UnsubscribeBooks()
+{
+   for(int i = 0; i < ArraySize(bookStates); i++)
+      if(bookStates[i].subscribed)
+         MarketBookRelease(symbolArray[i]);
+   ArrayFree(bookStates);
+}
+
+/**
+ * @brief Esvazia o livro de um símbolo.
+ */
+void BookReset(BookState &b)
+{
+   b.subscribed = false;
+   b.changed = false;
+   b.bidLevels = 0;
+   b.askLevels = 0;
+   ArrayInitialize(b.bidVolume, 0.0);
+   ArrayInitialize(b.askVolume, 0.0);
+   b.bidWeighted = 0.0;
+   b.askWeighted = 0.0;
+}
+
+/**
+ * @brief Grava o volume de um nível do livro, corrigindo a soma ponderada pela diferença.
+ * @param volumes  Volumes do lado do livro.
+ * @param weighted Soma ponderada do lado do livro.
+ * @param level    Nível (0 = melhor oferta).
+ * @param volume   Novo volume do nível.
+ * @return true se o volume do nível mudou.
+ */
+bool BookSetLevel(double &volumes[], double &weighted, int level, double volume)
+{
+   double old = volumes[level];
+   if(old == volume) return false;
+   volumes[level] = volume;
+   weighted += bookWeight[level] * (volume - old);
+   return true;
+}
+
+/**
+ * @brief Evento do livro de ofertas: atualiza no lugar o livro do símbolo.
+ */
+void OnBookEvent(const string &symbol)
+{
+   int i = SymbolIndex(symbol);
+   if(i < 0 || i >= ArraySize(bookStates)) return;
+   if(!MarketBookGet(symbol, bookBuffer)) return;
+   BookReserve();
+   if(BookApply(bookStates[i], bookBuffer)) bookStates[i].changed = true;
+}
+
+/**
+ * @brief Corrige um livro com uma cópia completa vinda de MarketBookGet, nível a nível.
+ *        Custo O(BOOK_DEPTH) por chamada; só os níveis alterados mexem nas somas.
+ * @param b    Livro do símbolo.
+ * @param book Entradas do livro, do maior para o menor preço.
+ * @return true se algum nível mudou.
+ */
+bool BookApply(BookState &b, const MqlBookInfo &book[])
+{
+   // O livro vem ordenado do maior para o menor preço: vendas primeiro, depois compras.
+   // A melhor venda é a última venda e a melhor compra é a primeira compra.
+   int total = ArraySize(book);
+   int sells = 0;
+   while(sells < total && (book[sells].type == BOOK_TYPE_SELL || book[sells].type == BOOK_TYPE_SELL_MARKET))
+      sells++;
+   int asks = MathMin(sells, BOOK_DEPTH);
+   int bids = MathMin(total - sells, BOOK_DEPTH);
+   
+   bool changed = false;
+   for(int k = 0; k < BOOK_DEPTH; k++)
+   {
+      double askVol = (k < asks) ? BookVolume(book[sells - 1 - k]) : 0.0;
+      double bidVol = (k < bids) ? BookVolume(book[sells + k]) : 0.0;
+      if(BookSetLevel(b.askVolume, b.askWeighted, k, askVol)) changed = true;
+      if(BookSetLevel(b.bidVolume, b.bidWeighted, k, bidVol)) changed = true;
+      // Além dos níveis ocupados antes e agora não há nada a corrigir
+      if(k >= asks && k >= bids && k >= b.askLevels && k >= b.bidLevels) break;
+   }
+   b.askLevels = asks;
+   b.bidLevels = bids;
+   return changed;
+}
+
+/**
+ * @brief Volume de uma entrada do livro (usa o volume fracionário quando existir).
+ */
+double BookVolume(const MqlBookInfo &entry)
+{
+   return (entry.volume_real > 0.0) ? entry.volume_real : (double)entry.volume;
+}
+
+/**
+ * @brief Mede o custo de um evento de livro com um livro sintético de BOOK_DEPTH níveis por lado:
+ *        a cada evento alguns níveis mudam de volume e o livro inteiro passa por BookApply, como
+ *        em OnBookEvent. Confere as somas ponderadas com o recálculo completo e a memória do
+ *        programa antes e depois (o caminho do evento não pode alocar).
+ *        Usa os pesos preparados por SubscribeBooks.
+ * @param file Arquivo CSV do benchmark.
+ * @return Quantidade de divergências (somas fora da tolerância ou memória que cresceu).
+ */
+int BookBenchmark(int file)
+{
+   MqlBookInfo book[];
+   ArrayResize(book, 2 * BOOK_DEPTH);
+   MathSrand(SYNTH_SEED);
+   for(int k = 0; k < 2 * BOOK_DEPTH; k++)
+   {
+      // Vendas do maior para o menor preço, depois compras
+      book[k].type = (k < BOOK_DEPTH) ? BOOK_TYPE_SELL : BOOK_TYPE_BUY;
+      book[k].price = 100.0 + (BOOK_DEPTH - k) * SYNTH_TICK_SIZE;
+      book[k].volume = 1 + MathRand() % 100;
+      book[k].volume_real = (double)book[k].volume;
+   }
+   BookState b;
+   BookReset(b);
+   BookApply(b, book);
+   
+   int mismatches = 0;
+   ulong elapsed = 0;
+   long mem0 = MQLInfoInteger(MQL_MEMORY_USED);
+   for(int e = 0; e < BENCH_BOOK_EVENTS; e++)
+   {
+      // Poucos níveis mudam por evento, quase sempre perto do topo do livro
+      int changes = 1 + MathRand() % 3;
+      for(int c = 0; c < changes; c++)
+      {
+         int k = (MathRand() % 2 == 0) ? BOOK_DEPTH - 1 - MathRand() % 4 : MathRand() % (2 * BOOK_DEPTH);
+         book[k].volume = 1 + MathRand() % 100;
+         book[k].volume_real = (double)book[k].volume;
+      }
+      ulong t = GetMicrosecondCount();
+      BookApply(b, book);
+      elapsed += GetMicrosecondCount() - t;
+      
+      // Confere uma amostra dos eventos com o recálculo completo das somas
+      if(e % 1000 != 0) continue;
+      double bid = 0.0, ask = 0.0;
+      for(int k = 0; k < BOOK_DEPTH; k++)
+      {
+         ask += bookWeight[k] * b.askVolume[k];
+         bid += bookWeight[k] * b.bidVolume[k];
+      }
+      if(MathAbs(ask - b.askWeighted) / MathMax(ask, 1e-12) > SELFCHECK_TOLERANCE ||
+         MathAbs(bid - b.bidWeighted) / MathMax(bid, 1e-12) > SELFCHECK_TOLERANCE)
+         mismatches++;
+   }
+   long memDelta = MQLInfoInteger(MQL_MEMORY_USED) - mem0;
+   if(memDelta > 0) mismatches++;
+   
+   double usPerEvent = (double)elapsed / BENCH_BOOK_EVENTS;
+   LOG_INFO(StringFormat("[0501] Livro: %d eventos de %d níveis por lado, %.3f µs por evento, memória %+I64d MB",
+                         BENCH_BOOK_EVENTS, BOOK_DEPTH, usPerEvent, memDelta));
+   BenchmarkCase(file, "book", BENCH_BOOK_EVENTS, usPerEvent, mismatches);
+   return mismatches;
+}
+
+/**
+ * @brief Pressão do DOM: participação da compra no volume ponderado pela profundidade (0 a 100).
+ * @param i Índice do símbolo em symbolArray.
+ */
+double CalculatePressaoDOM(int i)
+{
+   double total = bookStates[i].bidWeighted + bookStates[i].askWeighted;
+   return (total > 0.0) ? 100.0 * bookStates[i].bidWeighted / total : 50.0;
+}
+
+/**
+ * @brief Atualiza a célula de Pressão DOM de um símbolo.
+ * @param i Índice do símbolo em symbolArray.
+ */
+void UpdatePressaoDOMRow(int i)
+{
+   bookStates[i].changed = false;
+   double pressure = CalculatePressaoDOM(i);
+   color textColor = (pressure > 55.0) ? clrBuyGreen : (pressure < 45.0) ? clrSellRed : clrNeutralText;
+   SetMetric(TD_ROW_PRESSAO, i, pressure, textColor);
+   SetRowSignal(TD_ROW_PRESSAO, i, (pressure > 55.0) ? 1 : (pressure < 45.0) ? -1 : 0);
+}
+
+/**
+ * @brief Verifica se algum símbolo ainda tem recálculo pendente.
+ */
+bool AnySymbolPending()
+{
+   for(int i = 0; i < totalSymbols; i++)
+      if(symbolPending[i]) return true;
+   return false;
+}
+
+//+------------------------------------------------------------------+
+//| Motor de Resultados (RR, Win/Loss, Res. ativo e Saldo)           |
+//| O histórico do dia é lido uma única vez na inicialização; depois |
+//| cada negócio novo chega por OnTradeTransaction e é somado em     |
+//| O(1). O resultado aberto de um símbolo só é relido quando o      |
+//| preço dele muda (UpdateSymbolValues).                            |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Zera os resultados e carrega os negócios do dia a partir do histórico.
+ */
+void ResetResults()
+{
+   ArrayResize(tradeResults, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+      ZeroMemory(tradeResults[i]);
+   resultsRealizedTotal = 0.0;
+   resultsDay = SessionStart(TimeTradeServer());
+   positionsDirty = true;
+   
+   // O Saldo Geral ocupa só a coluna do primeiro símbolo
+   for(int i = 1; i < totalSymbols; i++)
+      SetCellValue(TD_ROW_SALDO, i, " ", clrNormalText);
+   for(int i = 0; i < totalSymbols; i++)
+      SetResultRows(i);
+   if(tickSource != TICK_SOURCE_LIVE) return; // Símbolos reproduzidos ou sintéticos não têm negócios
+   
+   if(!HistorySelect(resultsDay, TimeTradeServer() + 86400))
+   {
+      LOG_WARN("[1800] Histórico de negócios indisponível; resultados começam do zero");
+      return;
+   }
+   int deals = HistoryDealsTotal();
+   for(int k = 0; k < deals; k++)
+      ResultsFoldDeal(HistoryDealGetTicket(k));
+   for(int i = 0; i < totalSymbols; i++)
+      SetResultRows(i);
+   LOG_INFO("[1801] Resultados do dia carregados: " + IntegerToString(deals) + " negócios");
+}
+
+/**
+ * @brief Soma um negócio aos resultados do dia (e do símbolo, se for monitorado).
+ * @param ticket Ticket do negócio (já selecionado no histórico ou selecionável por HistoryDealSelect).
+ * @return Índice do símbolo do negócio, ou -1 se não for monitorado ou não for compra/venda.
+ */
+int ResultsFoldDeal(ulong ticket)
+{
+   if(ticket == 0) return -1;
+   ENUM_DEAL_TYPE type = (ENUM_DEAL_TYPE)HistoryDealGetInteger(ticket, DEAL_TYPE);
+   if(type != DEAL_TYPE_BUY && type != DEAL_TYPE_SELL) return -1; // Depósitos, créditos, etc.
+   
+   // Virada do dia: os resultados recomeçam
+   datetime day = SessionStart((datetime)HistoryDealGetInteger(ticket, DEAL_TIME));
+   if(day < resultsDay) return -1;
+   if(day > resultsDay) ResultsNewDay(day);
+   
+   ENUM_DEAL_ENTRY entry = (ENUM_DEAL_ENTRY)HistoryDealGetInteger(ticket, DEAL_ENTRY);
+   double costs = HistoryDealGetDouble(ticket, DEAL_COMMISSION) + HistoryDealGetDouble(ticket, DEAL_FEE);
+   double pnl = costs;
+   if(entry != DEAL_ENTRY_IN)
+      pnl += HistoryDealGetDouble(ticket, DEAL_PROFIT) + HistoryDealGetDouble(ticket, DEAL_SWAP);
+   resultsRealizedTotal += pnl;
+   
+   int i = SymbolIndex(HistoryDealGetString(ticket, DEAL_SYMBOL));
+   if(i < 0) return -1;
+   tradeResults[i].realized += pnl;
+   
+   // Cada saída conta como um acerto ou um erro
+   if(entry != DEAL_ENTRY_IN)
+   {
+      if(pnl > 0.0)
+      {
+         tradeResults[i].wins++;
+         tradeResults[i].grossWin += pnl;
+      }
+      else if(pnl < 0.0)
+      {
+         tradeResults[i].losses++;
+         tradeResults[i].grossLoss -= pnl;
+      }
+   }
+   return i;
+}
+
+/**
+ * @brief Recomeça os resultados realizados em um novo dia.
+ */
+void ResultsNewDay(datetime day)
+{
+   resultsDay = day;
+   resultsRealizedTotal = 0.0;
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      tradeResults[i].realized = 0.0;
+      tradeResults[i].wins = 0;
+      tradeResults[i].losses = 0;
+      tradeResults[i].grossWin = 0.0;
+      tradeResults[i].grossLoss = 0.0;
+      SetResultRows(i);
+   }
+}
+
+/**
+ * @brief Recalcula o resultado aberto de um símbolo (somente se ele tem posições abertas).
+ */
+void ResultsUpdateFloating(int i)
+{
+   if(tickSource != TICK_SOURCE_LIVE) return;
+   if(positionsDirty) ResultsCountPositions();
+   
+   double floating = 0.0;
+   if(tradeResults[i].openPositions > 0)
+   {
+      string symbol = symbolArray[i];
+      for(int k = PositionsTotal() - 1; k >= 0; k--)
+      {
+         if(PositionGetSymbol(k) != symbol) continue;
+         floating += PositionGetDouble(POSITION_PROFIT) + PositionGetDouble(POSITION_SWAP);
+      }
+   }
+   if(floating == tradeResults[i].floating) return;
+   tradeResults[i].floating = floating;
+   SetResultRows(i);
+}
+
+/**
+ * @brief Refaz a contagem de posições abertas por símbolo (após uma transação).
+ */
+void ResultsCountPositions()
+{
+   positionsDirty = false;
+   for(int i = 0; i < totalSymbols; i++)
+      tradeResults[i].openPositions = 0;
+   for(int k = PositionsTotal() - 1; k >= 0; k--)
+   {
+      int i = SymbolIndex(PositionGetSymbol(k));
+      if(i >= 0) tradeResults[i].openPositions++;
+   }
+}
+
+/**
+ * @brief Atualiza as linhas RR, Win/Loss e Res. ativo de um símbolo.
+ */
+void SetResultRows(int i)
+{
+   TradeResults r = tradeResults[i];
+   
+   // RR realizado: ganho médio / perda média
+   if(r.wins > 0 && r.losses > 0)
+   {
+      double rr = (r.grossWin / r.wins) / (r.grossLoss / r.losses);
+      SetMetric(TD_ROW_RR, i, rr, (rr >= 1.0) ? clrBuyGreen : clrSellRed);
+   }
+   else
+      SetCellValue(TD_ROW_RR, i, "-", clrNeutralText);
+   
+   SetCellValue(TD_ROW_WINLOSS, i, StringFormat("%d/%d", r.wins, r.losses),
+                (r.wins > r.losses) ? clrBuyGreen : (r.wins < r.losses) ? clrSellRed : clrNormalText);
+   
+   double result = r.realized + r.floating;
+   SetMetric(TD_ROW_RES_ATIVO, i, result, (result >= 0.0) ? clrBuyGreen : clrSellRed);
+}
+
+/**
+ * @brief Atualiza o Saldo Geral (realizado no dia + resultado aberto da conta), exibido
+ *        na coluna do primeiro símbolo. Custo O(1) por frame.
+ */
+void UpdateResultsTotal()
+{
+   datetime today = SessionStart(TimeTradeServer());
+   if(today > resultsDay) ResultsNewDay(today);
+   
+   double total = resultsRealizedTotal + ((tickSource == TICK_SOURCE_LIVE) ? AccountInfoDouble(ACCOUNT_PROFIT) : 0.0);
+   SetMetric(TD_ROW_SALDO, 0, total, (total >= 0.0) ? clrBuyGreen : clrSellRed);
+}
+
+/**
+ * @brief Evento de transação: cada negócio novo é somado aos resultados, sem reler o histórico.
+ */
+void OnTradeTransaction(const MqlTradeTransaction &trans, const MqlTradeRequest &request, const MqlTradeResult &result)
+{
+   if(trans.type == TRADE_TRANSACTION_POSITION)
+      positionsDirty = true;
+   if(trans.type != TRADE_TRANSACTION_DEAL_ADD || !HistoryDealSelect(trans.deal)) return;
+   
+   positionsDirty = true;
+   int i = ResultsFoldDeal(trans.deal);
+   if(i < 0) return;
+   
+   // Um negócio também muda o resultado aberto (posição aberta, reduzida ou encerrada)
+   tradeResults[i].floating = 0.0;
+   ResultsUpdateFloating(i);
+   SetResultRows(i);
+   LOG_DEBUG("[1802] Negócio " + IntegerToString((long)trans.deal) + " somado aos resultados de " + symbolArray[i]);
+}
+
+//+------------------------------------------------------------------+
+//| Exportação das Métricas                                          |
+//| A cada frame em que alguma métrica mudou, só os registros        |
+//| alterados são regravados, em trechos contíguos, no arquivo de    |
+//| layout fixo (ExportFile), entre as duas gravações do cabeçalho   |
+//| com o número de sequência. Outros programas leem o               |
+//| arquivo sem interpretar texto e sem bloquear o EA (ver o script  |
+//| PainelLeitor).                                                   |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Cria o arquivo de exportação com a tabela de símbolos e os registros iniciais.
+ */
+void ExportOpen()
+{
+   if(ExportFile == "") return;
+   exportHandle = FileOpen(ExportFile, FILE_WRITE | FILE_BIN | FILE_COMMON | FILE_SHARE_READ);
+   if(exportHandle == INVALID_HANDLE)
+   {
+      LOG_ERROR("[1900] Não foi possível criar o arquivo de exportação " + ExportFile);
+      return;
+   }
+   
+   int n = TD_ROW_COUNT * totalSymbols;
+   ArrayResize(exportRecords, n);
+   ArrayResize(exportSeen, n);
+   ArrayResize(exportDirty, n);
+   ArrayInitialize(exportSeen, 0);
+   for(int slot = 0; slot < n; slot++)
+   {
+      ZeroMemory(exportRecords[slot]);
+      exportRecords[slot].symbol = slot / TD_ROW_COUNT;
+      exportRecords[slot].row = slot % TD_ROW_COUNT;
+   }
+   exportSeq = 0;
+   
+   ZeroMemory(exportHeader);
+   exportHeader.magic = EXPORT_MAGIC;
+   exportHeader.version = EXPORT_VERSION;
+   exportHeader.symbols = totalSymbols;
+   exportHeader.rows = TD_ROW_COUNT;
+   exportHeader.recordSize = sizeof(ExportRecord);
+   FileWriteStruct(exportHandle, exportHeader);
+   
+   ExportSymbol sym;
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      ArrayInitialize(sym.name, 0);
+      StringToCharArray(symbolArray[i], sym.name, 0, EXPORT_NAME_LEN - 1);
+      FileWriteStruct(exportHandle, sym);
+   }
+   FileWriteArray(exportHandle, exportRecords);
+   FileFlush(exportHandle);
+   LOG_INFO("[1901] Exportando " + IntegerToString(n) + " métricas para " + ExportFile);
+}
+
+/**
+ * @brief Atualiza os registros que mudaram e regrava só eles, agrupados em trechos contíguos,
+ *        entre o cabeçalho com sequência ímpar e o com sequência par.
+ */
+void ExportFrame()
+{
+   if(exportHandle == INVALID_HANDLE) return;
+   
+   // Sequência ímpar: os registros abaixo ainda estão sendo gravados
+   ulong seq = 2 * exportSeq + 1;
+   datetime now = CurrentTime();
+   int changed = 0;
+   int n = ArraySize(exportRecords);
+   for(int slot = 0; slot < n; slot++)
+   {
+      int signal = rowSignal[slot];
+      if(exportSeen[slot] == metricVersion[slot] && exportRecords[slot].signal == signal) continue;
+      exportSeen[slot] = metricVersion[slot];
+      exportRecords[slot].signal = signal;
+      exportRecords[slot].flags = metricIsText[slot] ? 0 : 1;
+      exportRecords[slot].value = metricIsText[slot] ? 0.0 : metricValue[slot];
+      exportRecords[slot].seq = seq + 1;
+      exportRecords[slot].time = (long)now;
+      exportDirty[changed++] = slot;
+   }
+   if(changed == 0) return;
+   
+   exportHeader.seq = seq;
+   exportHeader.time = (long)now;
+   FileSeek(exportHandle, 0, SEEK_SET);
+   FileWriteStruct(exportHandle, exportHeader);
+   FileFlush(exportHandle);
+   
+   // Um FileSeek + FileWriteArray por trecho de registros alterados consecutivos
+   ulong base = sizeof(ExportHeader) + totalSymbols * sizeof(ExportSymbol);
+   for(int k = 0; k < changed; )
+   {
+      int first = exportDirty[k];
+      int count = 1;
+      while(k + count < changed && exportDirty[k + count] == first + count)
+         count++;
+      FileSeek(exportHandle, (long)(base + (ulong)first * sizeof(ExportRecord)), SEEK_SET);
+      FileWriteArray(exportHandle, exportRecords, first, count);
+      k += count;
+   }
+   
+   // Sequência par: gravação concluída (o flush leva os registros e o cabeçalho, nessa ordem)
+   exportSeq++;
+   exportHeader.seq = seq + 1;
+   FileSeek(exportHandle, 0, SEEK_SET);
+   FileWriteStruct(exportHandle, exportHeader);
+   FileFlush(exportHandle);
+}
+
+/**
+ * @brief Fecha o arquivo de exportação.
+ */
+void ExportClose()
+{
+   if(exportHandle == INVALID_HANDLE) return;
+   FileClose(exportHandle);
+   exportHandle = INVALID_HANDLE;
+}
+
+//+------------------------------------------------------------------+
+//| Snapshot do Estado (Inicialização a Quente)                      |
+//| Em OnDeinit, o estado incremental de cada símbolo (cursores de   |
+//| ticks, delta, perfil de volume, médias, Bollinger e ATR) é salvo |
+//| em SnapshotFile. Em OnInit ele é restaurado se a configuração    |
+//| for a mesma: os ticks continuam do cursor salvo e as séries se   |
+//| alinham às barras atuais (SeriesResumeShift), de modo que só o   |
+//| intervalo desde a última execução é recalculado. Estados de uma  |
+//| sessão anterior ou que não conferem com as barras são ignorados. |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Texto que identifica a configuração do painel; o snapshot só vale para a mesma configuração.
+ */
+string SnapshotFingerprint()
+{
+   string f = StringFormat("%d|%d|%d|%d|%d|%d|%.4f|%d|%d|%d",
+                           (int)((MATimeframe == PERIOD_CURRENT) ? Period() : MATimeframe), (int)MAHigherTF,
+                           (int)MAMethod, MAPeriod, MAHigherTFPeriod, BBPeriod, BBDeviation, ATRPeriod, DeltaWindowMinutes, SwingStrength);
+   for(int i = 0; i < totalSymbols; i++)
+      f += "|" + symbolArray[i];
+   return f;
+}
+
+void SnapshotWriteDoubles(int h, const double &a[])
+{
+   FileWriteInteger(h, ArraySize(a));
+   if(ArraySize(a) > 0) FileWriteArray(h, a);
+}
+
+bool SnapshotReadDoubles(int h, double &a[])
+{
+   int n = FileReadInteger(h);
+   if(n < 0 || n > 10000000) return false;
+   ArrayResize(a, n);
+   return n == 0 || FileReadArray(h, a, 0, n) == n;
+}
+
+void SnapshotWriteWindow(int h, const RollingWindow &w)
+{
+   SnapshotWriteDoubles(h, w.buf);
+   FileWriteInteger(h, w.size);
+   FileWriteInteger(h, w.head);
+   FileWriteInteger(h, w.count);
+   FileWriteDouble(h, w.sum);
+   FileWriteDouble(h, w.sumSq);
+}
+
+bool SnapshotReadWindow(int h, RollingWindow &w)
+{
+   if(!SnapshotReadDoubles(h, w.buf)) return false;
+   w.size = FileReadInteger(h);
+   w.head = FileReadInteger(h);
+   w.count = FileReadInteger(h);
+   w.sum = FileReadDouble(h);
+   w.sumSq = FileReadDouble(h);
+   return w.size == ArraySize(w.buf) && w.head >= 0 && w.head < MathMax(w.size, 1) && w.count <= w.size;
+}
+
+void SnapshotWriteSwing(int h, const SwingState &w)
+{
+   FileWriteInteger(h, w.strength);
+   SnapshotWriteDoubles(h, w.barHigh);
+   SnapshotWriteDoubles(h, w.barLow);
+   for(int k = 0; k < ArraySize(w.barTime); k++)
+      FileWriteLong(h, (long)w.barTime[k]);
+   FileWriteInteger(h, w.barHead);
+   FileWriteInteger(h, w.barCount);
+   for(int k = 0; k < SWING_MAX_PIVOTS; k++)
+   {
+      FileWriteDouble(h, w.pivots[k].price);
+      FileWriteLong(h, (long)w.pivots[k].time);
+      FileWriteInteger(h, w.pivots[k].isHigh ? 1 : 0);
+      FileWriteInteger(h, w.pivots[k].broken ? 1 : 0);
+   }
+   FileWriteInteger(h, w.pivotHead);
+   FileWriteInteger(h, w.pivotCount);
+   FileWriteInteger(h, w.trend);
+   FileWriteInteger(h, w.hasBreak ? 1 : 0);
+   FileWriteDouble(h, w.breakLevel);
+}
+
+bool SnapshotReadSwing(int h, SwingState &w)
+{
+   w.strength = FileReadInteger(h);
+   if(!SnapshotReadDoubles(h, w.barHigh) || !SnapshotReadDoubles(h, w.barLow)) return false;
+   int size = ArraySize(w.barHigh);
+   ArrayResize(w.barTime, size);
+   for(int k = 0; k < size; k++)
+      w.barTime[k] = (datetime)FileReadLong(h);
+   w.barHead = FileReadInteger(h);
+   w.barCount = FileReadInteger(h);
+   for(int k = 0; k < SWING_MAX_PIVOTS; k++)
+   {
+      w.pivots[k].price = FileReadDouble(h);
+      w.pivots[k].time = (datetime)FileReadLong(h);
+      w.pivots[k].isHigh = FileReadInteger(h) != 0;
+      w.pivots[k].broken = FileReadInteger(h) != 0;
+   }
+   w.pivotHead = FileReadInteger(h);
+   w.pivotCount = FileReadInteger(h);
+   w.trend = FileReadInteger(h);
+   w.hasBreak = FileReadInteger(h) != 0;
+   w.breakLevel = FileReadDouble(h);
+   bool valid = w.strength == MathMax(SwingStrength, 1) && size == 2 * w.strength + 1 && ArraySize(w.barLow) == size &&
+                w.barHead >= 0 && w.barHead < size && w.barCount >= 0 && w.barCount <= size &&
+                w.pivotHead >= 0 && w.pivotHead < SWING_MAX_PIVOTS && w.pivotCount <= SWING_MAX_PIVOTS;
+   // As filas não são gravadas: saem das barras da janela
+   if(valid) SwingRebuildQueues(w);
+   return valid;
+}
+
+void SnapshotWriteSeries(int h, const IndicatorSeries &s)
+{
+   FileWriteInteger(h, s.ready ? 1 : 0);
+   FileWriteLong(h, (long)s.barTime);
+   FileWriteDouble(h, s.close);
+   FileWriteDouble(h, s.closedClose);
+   FileWriteInteger(h, ArraySize(s.ma));
+   for(int m = 0; m < ArraySize(s.ma); m++)
+   {
+      SnapshotWriteWindow(h, s.ma[m].win);
+      FileWriteDouble(h, s.ma[m].emaClosed);
+      FileWriteInteger(h, s.ma[m].emaSeeded ? 1 : 0);
+      FileWriteDouble(h, s.ma[m].value);
+   }
+   if(s.hasBands)
+   {
+      SnapshotWriteWindow(h, s.bb);
+      FileWriteDouble(h, s.atr.atrClosed);
+      FileWriteDouble(h, s.atr.prevClose);
+      FileWriteInteger(h, s.atr.seedCount);
+      FileWriteDouble(h, s.atr.seedSum);
+      FileWriteDouble(h, s.atr.value);
+      SnapshotWriteSwing(h, s.swing);
+   }
+}
+
+/**
+ * @brief Lê o estado de uma série. Em caso de erro a série volta ao estado inicial
+ *        (será reconstruída pelo histórico).
+ */
+bool SnapshotReadSeries(int h, IndicatorSeries &s)
+{
+   bool ready = FileReadInteger(h) != 0;
+   s.barTime = (datetime)FileReadLong(h);
+   s.close = FileReadDouble(h);
+   s.closedClose = FileReadDouble(h);
+   bool ok = (FileReadInteger(h) == ArraySize(s.ma));
+   for(int m = 0; ok && m < ArraySize(s.ma); m++)
+   {
+      ok = SnapshotReadWindow(h, s.ma[m].win) && s.ma[m].win.size == s.ma[m].period;
+      s.ma[m].emaClosed = FileReadDouble(h);
+      s.ma[m].emaSeeded = FileReadInteger(h) != 0;
+      s.ma[m].value = FileReadDouble(h);
+   }
+   if(ok && s.hasBands)
+   {
+      ok = SnapshotReadWindow(h, s.bb);
+      s.atr.atrClosed = FileReadDouble(h);
+      s.atr.prevClose = FileReadDouble(h);
+      s.atr.seedCount = FileReadInteger(h);
+      s.atr.seedSum = FileReadDouble(h);
+      s.atr.value = FileReadDouble(h);
+      ok = ok && SnapshotReadSwing(h, s.swing);
+   }
+   if(!ok || !ready)
+   {
+      SeriesReset(s);
+      return ok;
+   }
+   // Pronta para uso imediato; o primeiro SeriesUpdate alinha o estado às barras atuais
+   s.ready = true;
+   s.restored = true;
+   return true;
+}
+
+void SnapshotWriteTickState(int h, int i)
+{
+   FileWriteLong(h, tickCursors[i].lastMsc);
+   FileWriteInteger(h, tickCursors[i].sameMscCount);
+   
+   FileWriteLong(h, (long)deltaStates[i].sessionDay);
+   FileWriteDouble(h, deltaStates[i].sessionDelta);
+   FileWriteDouble(h, deltaStates[i].lastBid);
+   FileWriteDouble(h, deltaStates[i].lastAsk);
+   FileWriteDouble(h, deltaStates[i].lastTrade);
+   FileWriteInteger(h, deltaStates[i].lastSide);
+   SnapshotWriteDoubles(h, deltaStates[i].bucket);
+   FileWriteInteger(h, ArraySize(deltaStates[i].bucketMinute));
+   if(ArraySize(deltaStates[i].bucketMinute) > 0) FileWriteArray(h, deltaStates[i].bucketMinute);
+   
+   FileWriteLong(h, (long)volumeProfiles[i].sessionDay);
+   FileWriteDouble(h, volumeProfiles[i].tickSize);
+   FileWriteLong(h, volumeProfiles[i].baseTick);
+   FileWriteInteger(h, volumeProfiles[i].binCount);
+   FileWriteDouble(h, volumeProfiles[i].maxVolume);
+   FileWriteInteger(h, volumeProfiles[i].pocBin);
+   SnapshotWriteDoubles(h, volumeProfiles[i].bins);
+   
+   FileWriteLong(h, (long)spreadStats[i].sessionDay);
+   FileWriteDouble(h, spreadStats[i].tickSize);
+   FileWriteArray(h, spreadStats[i].bins);
+   FileWriteLong(h, spreadStats[i].count);
+   FileWriteInteger(h, spreadStats[i].current);
+}
+
+/**
+ * @brief Lê os cursores de ticks, o delta, o perfil e o spread de um símbolo. O estado só é aplicado
+ *        se for da sessão atual; caso contrário o símbolo recomeça do início da sessão.
+ */
+bool SnapshotReadTickState(int h, int i)
+{
+   TickCursor c;
+   c.lastMsc = FileReadLong(h);
+   c.sameMscCount = FileReadInteger(h);
+   c.tradeFeed = tickCursors[i].tradeFeed;
+   
+   DeltaState d;
+   d.sessionDay = (datetime)FileReadLong(h);
+   d.sessionDelta = FileReadDouble(h);
+   d.lastBid = FileReadDouble(h);
+   d.lastAsk = FileReadDouble(h);
+   d.lastTrade = FileReadDouble(h);
+   d.lastSide = FileReadInteger(h);
+   d.windowDelta = 0.0;
+   if(!SnapshotReadDoubles(h, d.bucket)) return false;
+   int n = FileReadInteger(h);
+   if(n != ArraySize(d.bucket)) return false;
+   ArrayResize(d.bucketMinute, n);
+   if(n > 0 && FileReadArray(h, d.bucketMinute, 0, n) != n) return false;
+   
+   VolumeProfile p;
+   p.sessionDay = (datetime)FileReadLong(h);
+   p.tickSize = FileReadDouble(h);
+   p.baseTick = FileReadLong(h);
+   p.binCount = FileReadInteger(h);
+   p.maxVolume = FileReadDouble(h);
+   p.pocBin = FileReadInteger(h);
+   if(!SnapshotReadDoubles(h, p.bins) || p.binCount > ArraySize(p.bins) || p.binCount > PROFILE_MAX_BINS) return false;
+   
+   SpreadStats sp;
+   sp.sessionDay = (datetime)FileReadLong(h);
+   sp.tickSize = FileReadDouble(h);
+   if(FileReadArray(h, sp.bins, 0, SPREAD_BINS) != SPREAD_BINS) return false;
+   sp.count = FileReadLong(h);
+   sp.current = FileReadInteger(h);
+   
+   // Estado de outra sessão (ou de um feed com outro tick size): recomeça do início da sessão
+   datetime session = deltaStates[i].sessionDay;
+   if(d.sessionDay != session || p.sessionDay != session || p.tickSize != volumeProfiles[i].tickSize ||
+      sp.sessionDay != session || sp.tickSize != spreadStats[i].tickSize ||
+      c.lastMsc < (long)session * 1000 || ArraySize(d.bucket) != ArraySize(deltaStates[i].bucket))
+      return true;
+   
+   tickCursors[i] = c;
+   
+   deltaStates[i].sessionDelta = d.sessionDelta;
+   deltaStates[i].lastBid = d.lastBid;
+   deltaStates[i].lastAsk = d.lastAsk;
+   deltaStates[i].lastTrade = d.lastTrade;
+   deltaStates[i].lastSide = d.lastSide;
+   ArrayCopy(deltaStates[i].bucket, d.bucket);
+   ArrayCopy(deltaStates[i].bucketMinute, d.bucketMinute);
+   
+   volumeProfiles[i].baseTick = p.baseTick;
+   volumeProfiles[i].binCount = p.binCount;
+   volumeProfiles[i].maxVolume = p.maxVolume;
+   volumeProfiles[i].pocBin = p.pocBin;
+   ArraySwap(volumeProfiles[i].bins, p.bins);
+   
+   spreadStats[i] = sp;
+   return true;
+}
+
+/**
+ * @brief Salva o estado de todos os símbolos em SnapshotFile (apenas no modo ao vivo).
+ */
+void SnapshotSave()
+{
+   if(SnapshotFile == "" || tickSource != TICK_SOURCE_LIVE) return;
+   int h = FileOpen(SnapshotFile, FILE_WRITE | FILE_BIN);
+   if(h == INVALID_HANDLE)
+   {
+      LOG_WARN("[1701] Não foi possível salvar o estado em " + SnapshotFile);
+      return;
+   }
+   string fingerprint = SnapshotFingerprint();
+   FileWriteInteger(h, SNAPSHOT_MAGIC);
+   FileWriteInteger(h, SNAPSHOT_VERSION);
+   FileWriteInteger(h, StringLen(fingerprint));
+   FileWriteString(h, fingerprint);
+   FileWriteInteger(h, totalSymbols);
+   for(int i = 0; i < totalSymbols; i++)
+   {
+      SnapshotWriteTickState(h, i);
+      SnapshotWriteSeries(h, mainSeries[i]);
+      SnapshotWriteSeries(h, htfSeries[i]);
+   }
+   FileClose(h);
+   LOG_INFO("[1702] Estado de " + IntegerToString(totalSymbols) + " símbolos salvo em " + SnapshotFile);
+}
+
+/**
+ * @brief Restaura o estado salvo por SnapshotSave, se o arquivo for da mesma versão e configuração.
+ * @return true se o estado foi restaurado.
+ */
+bool SnapshotLoad()
+{
+   if(SnapshotFile == "" || tickSource != TICK_SOURCE_LIVE || !FileIsExist(SnapshotFile)) return false;
+   int h = FileOpen(SnapshotFile, FILE_READ | FILE_BIN);
+   if(h == INVALID_HANDLE) return false;
+   
+   bool ok = FileReadInteger(h) == SNAPSHOT_MAGIC && FileReadInteger(h) == SNAPSHOT_VERSION;
+   if(ok)
+   {
+      int len = FileReadInteger(h);
+      ok = (len > 0 && FileReadString(h, len) == SnapshotFingerprint() && FileReadInteger(h) == totalSymbols);
+   }
+   if(!ok)
+   {
+      FileClose(h);
+      LOG_INFO("[1703] Estado salvo ignorado: versão ou configuração diferente");
+      return false;
+   }
+   
+   for(int i = 0; ok && i < totalSymbols; i++)
+      ok = SnapshotReadTickState(h, i) && SnapshotReadSeries(h, mainSeries[i]) && SnapshotReadSeries(h, htfSeries[i]);
+   FileClose(h);
+   
+   if(!ok)
+   {
+      // Arquivo corrompido: descarta tudo o que foi lido e recomeça do zero
+      LOG_WARN("[1704] Estado salvo corrompido; recalculando a partir do histórico");
+      ResetIndicatorSeries();
+      ResetTickStreams();
+      return false;
+   }
+   LOG_INFO("[1705] Estado de " + IntegerToString(totalSymbols) + " símbolos restaurado de " + SnapshotFile);
+   return true;
+}
+
+//+------------------------------------------------------------------+
+//| Log com Níveis                                                   |
+//| As mensagens são guardadas em um buffer circular e enviadas ao   |
+//| diário uma vez por ciclo do timer. LOG_DEBUG some da compilação  |
+//| quando TD_DEBUG_LOG não está definido.                           |
+//+------------------------------------------------------------------+
+
+/**
+ * @brief Guarda uma mensagem no buffer do log. Se o buffer estiver cheio,
+ *        a mensagem mais antiga é descartada e contabilizada.
+ * @param level Nível da mensagem.
+ * @param msg   Texto da mensagem.
+ */
+void LogWrite(ENUM_TD_LOG_LEVEL level, string msg)
+{
+   string tag = (level == TD_LOG_DEBUG) ? "DEBUG" : (level == TD_LOG_INFO) ? "INFO" : (level == TD_LOG_WARN) ? "WARN" : "ERROR";
+   
+   if(logCount == LOG_RING_SIZE)
+   {
+      logHead = (logHead + 1) % LOG_RING_SIZE;
+      logCount--;
+      logDropped++;
+   }
+   logRing[(logHead + logCount) % LOG_RING_SIZE] = tag + " " + msg;
+   logCount++;
+}
+
+/**
+ * @brief Envia ao diário todas as mensagens pendentes no buffer do log, unidas por "\n"
+ *        em um único Print (ou em blocos de até LOG_PRINT_CHARS caracteres).
+ */
+void LogFlush()
+{
+   string batch = "";
+   if(logDropped > 0)
+   {
+      batch = "WARN [0900] " + IntegerToString((long)logDropped) + " mensagens de log descartadas (buffer cheio)";
+      logDropped = 0;
+   }
+   for(int k = 0; k < logCount; k++)
+   {
+      int pos = (logHead + k) % LOG_RING_SIZE;
+      // Bloco cheio: envia o que já foi unido e começa outro
+      if(batch != "" && StringLen(batch) + 1 + StringLen(logRing[pos]) > LOG_PRINT_CHARS)
+      {
+         Print(batch);
+         batch = "";
+      }
+      batch = (batch == "") ? logRing[pos] : batch + "\n" + logRing[pos];
+      logRing[pos] = NULL;
+   }
+   if(batch != "") Print(batch);
+   logHead = 0;
+   logCount = 0;
+}
+
+//+------------------------------------------------------------------+
+//| Função de Desinicialização do Expert                             |
+//| É executada quando o EA é removido do gráfico.                   |
+//+------------------------------------------------------------------+
+void OnDeinit(const int reason)
 {
+   // Para o timer dos frames de atualização
+   EventKillTimer();
+   
+   // Salva o estado calculado para a próxima inicialização
+   SnapshotSave();
+   
+   // Cancela as assinaturas do livro de ofertas e libera os handles de indicadores
+   UnsubscribeBooks();
+   ReleaseIndicatorPool();
+   
+   // Fecha os arquivos de gravação/reprodução de ticks
+   RecordClose();
+   ReplayClose();
+   ExportClose();
+   
+   // Descarrega as mensagens que ainda estão no buffer do log
+   LogFlush();
+   
    // Remove todos os objetos gráficos criados por este EA para não poluir o gráfico.
    // O prefixo "TD_" (Trend Detector) garante que apenas os nossos objetos sejam removidos.
    ObjectsDeleteAll(0, "TD_");
+   // Libera o bitmap da tabela (modo UseCanvasRenderer)
+   CanvasDestroy();
 }
@@ -0,0 +1,105 @@
+//+------------------------------------------------------------------+
+//|                                Copyright 2024, MetaQuotes Software Corp. |
+//|                                             https://www.metaquotes.net/ |
+//+------------------------------------------------------------------+
+//|                  LEITOR DA EXPORTAÇÃO DO PAINEL                  |
+//|                                                                  |
+//| Script de verificação do arquivo exportado pelo Painel Detector  |
+//| de Tendência (entrada ExportFile). Lê o arquivo continuamente    |
+//| durante alguns segundos, como faria um programa externo, e       |
+//| informa quantas leituras consistentes, leituras descartadas      |
+//| (gravação em andamento) e frames novos foram obtidos.            |
+//+------------------------------------------------------------------+
+#property strict
+#property script_show_inputs
+
+input string ExportFile = "td_export.bin"; // Arquivo exportado pelo painel (pasta comum dos terminais)
+input int    ReadSeconds = 10;             // Duração da leitura em segundos
+
+//--- O layout abaixo deve ser idêntico ao de Painel.cpp (ExportHeader, ExportSymbol, ExportRecord)
+#define EXPORT_MAGIC        0x58454454
+#define EXPORT_VERSION      1
+#define EXPORT_NAME_LEN     32
+
+struct ExportHeader
+{
+   uint  magic;
+   uint  version;
+   ulong seq;
+   long  time;
+   int   symbols;
+   int   rows;
+   int   recordSize;
+   int   reserved;
+};
+
+struct ExportSymbol
+{
+   uchar name[EXPORT_NAME_LEN];
+};
+
+struct ExportRecord
+{
+   int    symbol;
+   int    row;
+   int    signal;
+   int    flags;
+   double value;
+   ulong  seq;
+   long   time;
+};
+
+//+------------------------------------------------------------------+
+//| Função principal do script                                       |
+//+------------------------------------------------------------------+
+void OnStart()
+{
+   ExportRecord records[];
+   ExportHeader first, last;
+   long reads = 0, torn = 0, frames = 0;
+   ulong lastSeq = 0;
+   ulong start = GetMicrosecondCount();
+   ulong limit = (ulong)MathMax(ReadSeconds, 1) * 1000000;
+
+   while(GetMicrosecondCount() - start < limit && !IsStopped())
+   {
+      int h = FileOpen(ExportFile, FILE_READ | FILE_BIN | FILE_COMMON | FILE_SHARE_READ | FILE_SHARE_WRITE);
+      if(h == INVALID_HANDLE)
+      {
+         Print("Arquivo de exportação não encontrado: ", ExportFile);
+         return;
+      }
+
+      // Leitura sem trava: sequência, registros e sequência de novo
+      bool ok = FileReadStruct(h, first) == sizeof(ExportHeader) && first.magic == EXPORT_MAGIC &&
+                first.version == EXPORT_VERSION && first.recordSize == sizeof(ExportRecord);
+      if(ok && (first.seq & 1) == 0)
+      {
+         int n = first.symbols * first.rows;
+         FileSeek(h, sizeof(ExportHeader) + first.symbols * sizeof(ExportSymbol), SEEK_SET);
+         ArrayResize(records, n);
+         ok = FileReadArray(h, records, 0, n) == (uint)n;
+         FileSeek(h, 0, SEEK_SET);
+         ok = ok && FileReadStruct(h, last) == sizeof(ExportHeader) && last.seq == first.seq;
+      }
+      else ok = false;
+      FileClose(h);
+
+      reads++;
+      if(!ok)
+      {
+         torn++;
+         continue;
+      }
+      if(first.seq != lastSeq)
+      {
+         frames++;
+         lastSeq = first.seq;
+      }
+      Sleep(1);
+   }
+
+   double seconds = (GetMicrosecondCount() - start) / 1000000.0;
+   PrintFormat("Leituras: %I64d (%.0f/s), descartadas: %I64d, frames novos: %I64d (%.1f/s), registros por frame: %d",
+               reads, reads / seconds, torn, frames, frames / seconds, ArraySize(records));
+}